@@ -0,0 +1,246 @@
+static char help[] = {
+   "Usage: cc20-bench [ -n <samples> ] [ -t <milliseconds> ] "
+   "[ -w <milliseconds> ]\n"
+   "\n"
+   "Measures every ChaCha keystream kernel which the CPU supports in "
+   "isolation, for 20, 12 and 8 rounds. Every kernel is first called "
+   "repeatedly for the -w warm-up time (default 100 ms). Then the number "
+   "of calls per sample is doubled until a sample takes at least the -t "
+   "sample time (default 2 ms), and -n samples (default 31) are taken.\n"
+   "\n"
+   "The output has one line for each kernel and number of rounds: The "
+   "octets per call, the median of the nanoseconds per call, the 10th "
+   "percentile, the median and the 90th percentile of the cycles per "
+   "octet, and the throughput in MB/s calculated from the median time.\n"
+   "\n"
+   "Cycles are counted with perf_event_open() if the kernel allows it. "
+   "Otherwise the time stamp counter is read on x86, which counts at a "
+   "fixed reference frequency. Without either, the cycle columns show "
+   "'-'. The first output line tells which counter has been used.\n"
+   "\n"
+   "Version 2026.290\n"
+   "Copyright (c) 2026 Guenther Brunthaler. All rights reserved.\n"
+   "\n"
+   "This source file is free software.\n"
+   "Distribution is permitted under the terms of the GPLv3.\n"
+};
+
+#ifdef HAVE_CONFIG_H
+   #include "config.h"
+#endif
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <assert.h>
+#ifdef HAVE_UNISTD_H
+   #include <unistd.h>
+#endif
+#if defined HAVE_LINUX_PERF_EVENT_H && defined HAVE_SYS_SYSCALL_H
+   #include <sys/syscall.h>
+   #include <linux/perf_event.h>
+   #define HAVE_PERF_EVENTS
+#endif
+#include "cc20_block.h"
+
+#if defined __GNUC__ && (defined __x86_64__ || defined __i386__)
+   #define HAVE_RDTSC
+#endif
+
+#define CALL_OCTETS (64 * CC20_BLOCK_SIZE)
+#define MAX_SAMPLES 1000
+
+static uint32_t state[16];
+static unsigned char buffer[CALL_OCTETS];
+static unsigned current_rounds;
+
+#ifdef HAVE_PERF_EVENTS
+   static int perf_fd = -1;
+#endif
+static char const *cycle_source = "none";
+
+static void die(char const *msg) {
+   (void)fputs(msg, stderr);
+   (void)fputc('\n', stderr);
+   exit(EXIT_FAILURE);
+}
+
+/* Select the best available cycle counter. */
+static void cycles_init(void) {
+   #ifdef HAVE_PERF_EVENTS
+   {
+      struct perf_event_attr pe;
+      (void)memset(&pe, 0, sizeof pe);
+      pe.type = PERF_TYPE_HARDWARE; pe.size = sizeof pe;
+      pe.config = PERF_COUNT_HW_CPU_CYCLES;
+      pe.exclude_kernel = pe.exclude_hv = 1;
+      if (
+         (perf_fd = (int)syscall(SYS_perf_event_open, &pe, 0, -1, -1, 0))
+         >= 0
+      ) {
+         cycle_source = "perf_event_open (core cycles)";
+         return;
+      }
+   }
+   #endif
+   #ifdef HAVE_RDTSC
+      cycle_source = "rdtsc (reference cycles)";
+   #endif
+}
+
+/* Returns 0 if there is no cycle counter. */
+static int cycles_read(uint64_t *c) {
+   #ifdef HAVE_PERF_EVENTS
+      if (perf_fd >= 0) {
+         return read(perf_fd, c, sizeof *c) == (ssize_t)sizeof *c;
+      }
+   #endif
+   #ifdef HAVE_RDTSC
+      *c = __builtin_ia32_rdtsc();
+      return 1;
+   #else
+      (void)c;
+      return 0;
+   #endif
+}
+
+static uint64_t now_ns(void) {
+   struct timespec ts;
+   if (clock_gettime(CLOCK_MONOTONIC, &ts)) die("clock_gettime() failed!");
+   return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+static void call(void) {
+   cc20_xor(state, current_rounds, 0, buffer, buffer, sizeof buffer);
+}
+
+/* Call the kernel <calls> times. Returns the elapsed nanoseconds and sets
+ * <*cyc> to the elapsed cycles, or to 0 if there is no cycle counter. */
+static uint64_t sample(unsigned long calls, uint64_t *cyc) {
+   uint64_t t0, t1, c0, c1;
+   int have_cycles;
+   unsigned long n;
+   t0 = now_ns(); have_cycles = cycles_read(&c0);
+   for (n = calls; n--; ) call();
+   if (!have_cycles || !cycles_read(&c1)) c0 = c1 = 0;
+   t1 = now_ns();
+   *cyc = c1 - c0;
+   return t1 - t0;
+}
+
+static int cmp_double(void const *a, void const *b) {
+   double const x = *(double const *)a, y = *(double const *)b;
+   return x < y ? -1 : x > y;
+}
+
+/* Nearest-rank percentile <p> of the sorted <v>[<n>]. */
+static double percentile(double const *v, unsigned n, unsigned p) {
+   return v[(n - 1) * p / 100];
+}
+
+static unsigned long numeric_arg(char const *arg) {
+   long n;
+   char *end;
+   if ((n = strtol(arg, &end, 10)) < 1 || *end) {
+      (void)fputs(help, stderr);
+      exit(EXIT_FAILURE);
+   }
+   return (unsigned long)n;
+}
+
+int main(int argc, char **argv) {
+   unsigned long samples = 31, sample_ms = 2, warmup_ms = 100;
+   static double ns_per_call[MAX_SAMPLES], cyc_per_octet[MAX_SAMPLES];
+   unsigned max_lanes, lanes;
+   {
+      int opt;
+      while ((opt = getopt(argc, argv, "n:t:w:h")) != -1) {
+         switch (opt) {
+            case 'n': samples = numeric_arg(optarg); break;
+            case 't': sample_ms = numeric_arg(optarg); break;
+            case 'w': warmup_ms = numeric_arg(optarg); break;
+            case 'h':
+               if (fputs(help, stdout) < 0 || fflush(stdout)) {
+                  die("Write error!");
+               }
+               return EXIT_SUCCESS;
+            default: (void)fputs(help, stderr); return EXIT_FAILURE;
+         }
+      }
+      if (optind < argc) { (void)fputs(help, stderr); return EXIT_FAILURE; }
+      if (samples > MAX_SAMPLES) die("Too many samples requested!");
+   }
+   /* Arbitrary but fixed key and nonce. Any values work equally well. */
+   {
+      unsigned k;
+      for (k = 16; k--; ) state[k] = 0x9e3779b9u * (k + 1);
+   }
+   cycles_init();
+   if (
+      printf("# cycles: %s\n", cycle_source) < 0
+      || printf(
+         "# %-20s %8s %10s %9s %9s %9s %9s\n", "kernel", "octets"
+         , "ns/call", "cyc/B p10", "cyc/B med", "cyc/B p90", "MB/s"
+      ) < 0
+   ) {
+      die("Write error!");
+   }
+   /* Measure the widest kernel, then the next narrower one and so on. */
+   for (max_lanes = UINT_MAX; max_lanes; max_lanes = lanes - 1) {
+      static unsigned const all_rounds[] = {20, 12, 8};
+      unsigned r;
+      lanes = cc20_init_lanes(max_lanes);
+      for (r = 0; r < sizeof all_rounds / sizeof *all_rounds; ++r) {
+         unsigned long calls;
+         uint64_t ns, cyc;
+         int have_cycles = 1;
+         unsigned s;
+         char name[32];
+         current_rounds = all_rounds[r];
+         (void)sprintf(name, "chacha%u-x%u", current_rounds, lanes);
+         /* Warm up. */
+         {
+            uint64_t const start = now_ns();
+            do call(); while (now_ns() - start < warmup_ms * 1000000);
+         }
+         /* Calibrate the number of calls per sample. */
+         for (calls = 1; sample(calls, &cyc) < sample_ms * 1000000; ) {
+            calls += calls;
+         }
+         for (s = 0; s < samples; ++s) {
+            ns = sample(calls, &cyc);
+            ns_per_call[s] = (double)ns / calls;
+            if (!cyc) have_cycles = 0;
+            cyc_per_octet[s] = (double)cyc / calls / CALL_OCTETS;
+         }
+         qsort(ns_per_call, samples, sizeof *ns_per_call, cmp_double);
+         qsort(cyc_per_octet, samples, sizeof *cyc_per_octet, cmp_double);
+         if (
+            printf(
+               "%-22s %8u %10.1f", name, (unsigned)CALL_OCTETS
+               , percentile(ns_per_call, samples, 50)
+            ) < 0
+            || (
+               have_cycles
+               ? printf(
+                  " %9.2f %9.2f %9.2f"
+                  , percentile(cyc_per_octet, samples, 10)
+                  , percentile(cyc_per_octet, samples, 50)
+                  , percentile(cyc_per_octet, samples, 90)
+               )
+               : printf(" %9s %9s %9s", "-", "-", "-")
+            ) < 0
+            || printf(
+               " %9.1f\n"
+               , CALL_OCTETS * 1e3 / percentile(ns_per_call, samples, 50)
+            ) < 0
+         ) {
+            die("Write error!");
+         }
+      }
+   }
+   if (fflush(0)) die("Write error!");
+   return EXIT_SUCCESS;
+}
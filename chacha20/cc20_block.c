@@ -0,0 +1,193 @@
+/*
+ * ChaCha20 keystream engine with run-time CPU dispatch.
+ *
+ * Version 2026.290
+ *
+ * Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+ *
+ * This source file is free software.
+ * Distribution is permitted under the terms of the GPLv3.
+ */
+
+#ifdef HAVE_CONFIG_H
+   #include "config.h"
+#endif
+#include "cc20_block.h"
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+
+#include "cc20_struct.h"
+
+#define ROTL32(x, n) ((x) << (n) | (x) >> (32 - (n)))
+
+/* R4() from ChaCha20.adoc. Works for scalars as well as for vectors, using
+ * <rotl> for the rotations. */
+#define QUARTER_ROUND(rotl, a, b, c, d) \
+   a += b; d ^= a; d = rotl(d, 16); \
+   c += d; b ^= c; b = rotl(b, 12); \
+   a += b; d ^= a; d = rotl(d, 8); \
+   c += d; b ^= c; b = rotl(b, 7)
+
+/* A 'column' round followed by a 'diagonal' round. */
+#define DOUBLE_ROUND(rotl, x) \
+   QUARTER_ROUND(rotl, x[0], x[4], x[8], x[12]); \
+   QUARTER_ROUND(rotl, x[1], x[5], x[9], x[13]); \
+   QUARTER_ROUND(rotl, x[2], x[6], x[10], x[14]); \
+   QUARTER_ROUND(rotl, x[3], x[7], x[11], x[15]); \
+   QUARTER_ROUND(rotl, x[0], x[5], x[10], x[15]); \
+   QUARTER_ROUND(rotl, x[1], x[6], x[11], x[12]); \
+   QUARTER_ROUND(rotl, x[2], x[7], x[8], x[13]); \
+   QUARTER_ROUND(rotl, x[3], x[4], x[9], x[14])
+
+/* Converts a keystream word into the native representation of its
+ * little-endian serialization. */
+#ifdef WORDS_BIGENDIAN
+   #define LE32(w) ( \
+      (w) >> 24 | (w) >> 8 & 0xff00u | (w) << 8 & 0xff0000u | (w) << 24 \
+   )
+#else
+   #define LE32(w) (w)
+#endif
+
+#define CC20_XN_CAT2(a, b) a ## b
+#define CC20_XN_CAT(a, b) CC20_XN_CAT2(a, b)
+
+/* Processes <groups> times <lanes> blocks. */
+typedef void kernel_fn(
+   uint32_t const *state, unsigned rounds, uint64_t block,
+   unsigned char *dst, unsigned char const *src, size_t groups
+);
+
+/* Computes a single keystream block into <out>. */
+static void block_x1(
+   uint32_t *out, uint32_t const *state, unsigned rounds, uint64_t block
+) {
+   uint32_t in[16];
+   unsigned k;
+   (void)memcpy(in, state, sizeof in);
+   in[CC20_POS_O] = (uint32_t)block;
+   in[CC20_POS_O + 1] = (uint32_t)(block >> 32);
+   (void)memcpy(out, in, sizeof in);
+   for (k = rounds / 2; k--; ) { DOUBLE_ROUND(ROTL32, out); }
+   for (k = 16; k--; ) out[k] += in[k];
+}
+
+static void xor_x1(
+   uint32_t const *state, unsigned rounds, uint64_t block,
+   unsigned char *dst, unsigned char const *src, size_t groups
+) {
+   for (; groups--; ++block) {
+      uint32_t ks[16];
+      unsigned k;
+      block_x1(ks, state, rounds, block);
+      for (k = 0; k < 16; ++k) {
+         uint32_t w;
+         (void)memcpy(&w, src, sizeof w);
+         w ^= LE32(ks[k]);
+         (void)memcpy(dst, &w, sizeof w);
+         src += sizeof w; dst += sizeof w;
+      }
+   }
+}
+
+#if defined HAVE_X86_DISPATCH
+   #define CC20_XN_LANES 16
+   #define CC20_XN_NAME xor_x16_avx512
+   #define CC20_XN_TARGET __attribute__((target("avx512f")))
+   #include "cc20_xn.h"
+   #undef CC20_XN_TARGET
+   #undef CC20_XN_NAME
+   #undef CC20_XN_LANES
+
+   #define CC20_XN_LANES 8
+   #define CC20_XN_NAME xor_x8_avx2
+   #define CC20_XN_TARGET __attribute__((target("avx2")))
+   #define CC20_XN_BYTE_ROTATE
+   #include "cc20_xn.h"
+   #undef CC20_XN_BYTE_ROTATE
+   #undef CC20_XN_TARGET
+   #undef CC20_XN_NAME
+   #undef CC20_XN_LANES
+
+   #define CC20_XN_LANES 4
+   #define CC20_XN_NAME xor_x4_sse2
+   #define CC20_XN_TARGET __attribute__((target("sse2")))
+   #include "cc20_xn.h"
+   #undef CC20_XN_TARGET
+   #undef CC20_XN_NAME
+   #undef CC20_XN_LANES
+#elif defined HAVE_VECTOR_SIZE_ATTRIBUTE
+   /* Whatever SIMD instructions the baseline architecture provides. */
+   #define CC20_XN_LANES 4
+   #define CC20_XN_NAME xor_x4_generic
+   #define CC20_XN_TARGET
+   #include "cc20_xn.h"
+   #undef CC20_XN_TARGET
+   #undef CC20_XN_NAME
+   #undef CC20_XN_LANES
+#endif
+
+/* The selected kernels, widest first. The last one is always xor_x1. */
+static struct {
+   kernel_fn *xor;
+   unsigned lanes;
+} kernels[4];
+
+unsigned cc20_init_lanes(unsigned max_lanes) {
+   unsigned n = 0;
+   assert(max_lanes >= 1);
+   #define ADD_KERNEL(name, lanes_) \
+      if (lanes_ <= max_lanes) \
+         kernels[n].xor = name, kernels[n++].lanes = lanes_
+   #if defined HAVE_X86_DISPATCH
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx512f")) {
+         ADD_KERNEL(xor_x16_avx512, 16);
+      }
+      if (__builtin_cpu_supports("avx2")) { ADD_KERNEL(xor_x8_avx2, 8); }
+      if (__builtin_cpu_supports("sse2")) { ADD_KERNEL(xor_x4_sse2, 4); }
+   #elif defined HAVE_VECTOR_SIZE_ATTRIBUTE
+      ADD_KERNEL(xor_x4_generic, 4);
+   #endif
+   ADD_KERNEL(xor_x1, 1);
+   #undef ADD_KERNEL
+   assert(n <= sizeof kernels / sizeof *kernels);
+   return kernels[0].lanes;
+}
+
+void cc20_init(void) {
+   (void)cc20_init_lanes(UINT_MAX);
+}
+
+void cc20_xor(
+   uint32_t const *state, unsigned rounds, uint64_t block,
+   void *dst, void const *src, size_t bytes
+) {
+   unsigned char *d = dst;
+   unsigned char const *s = src;
+   size_t blocks = bytes / CC20_BLOCK_SIZE;
+   unsigned i;
+   assert(kernels[0].lanes);
+   assert(rounds % 2 == 0);
+   for (i = 0; blocks; ++i) {
+      size_t groups;
+      assert(i < sizeof kernels / sizeof *kernels);
+      if (groups = blocks / kernels[i].lanes) {
+         size_t done = groups * kernels[i].lanes;
+         kernels[i].xor(state, rounds, block, d, s, groups);
+         block += done; blocks -= done;
+         d += done * CC20_BLOCK_SIZE; s += done * CC20_BLOCK_SIZE;
+      }
+   }
+   if (bytes %= CC20_BLOCK_SIZE) {
+      /* Final partial block. */
+      uint32_t ks[16];
+      unsigned char o[CC20_BLOCK_SIZE];
+      unsigned k;
+      block_x1(ks, state, rounds, block);
+      for (k = 16; k--; ) ks[k] = LE32(ks[k]);
+      (void)memcpy(o, ks, sizeof o);
+      for (k = 0; k < bytes; ++k) d[k] = s[k] ^ o[k];
+   }
+}
@@ -0,0 +1,48 @@
+/*
+ * #include "cc20_block.h"
+ *
+ * ChaCha20 keystream engine. Generates many keystream blocks at once using
+ * the widest multi-block kernel which the CPU supports and combines them
+ * with the data.
+ *
+ * Version 2026.290
+ *
+ * Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+ *
+ * This source file is free software.
+ * Distribution is permitted under the terms of the GPLv3.
+ */
+
+#ifndef HEADER_YZZHLPGFA4FVWGJCUR7XNBVIU_INCLUDED
+#define HEADER_YZZHLPGFA4FVWGJCUR7XNBVIU_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Octets per ChaCha20 keystream block. */
+#define CC20_BLOCK_SIZE 64
+
+/* Determine which kernels the CPU supports and select the fastest ones.
+ * Must be called once before using any other function declared here, and
+ * before any threads are created which might use them. */
+void cc20_init(void);
+
+/* Like cc20_init(), but only selects kernels which compute at most
+ * <max_lanes> (at least 1) blocks at once. Returns the number of blocks
+ * the widest selected kernel computes at once. Allows to measure or to
+ * test the narrower kernels on a CPU which would not use them otherwise. */
+unsigned cc20_init_lanes(unsigned max_lanes);
+
+/* XOR <bytes> octets read from <src> with the keystream generated from the
+ * 16-word <state> using <rounds> rounds and write the result to <dst>.
+ * <rounds> must be even; 20 is standard ChaCha20, 12 and 8 are the reduced
+ * variants ChaCha12 and ChaCha8. The keystream starts at the beginning of
+ * the block with index <block>; the block index words within <state> will
+ * be ignored. <dst> and <src> may be the same buffer but must
+ * not overlap otherwise. A final partial block is allowed. */
+void cc20_xor(
+   uint32_t const *state, unsigned rounds, uint64_t block,
+   void *dst, void const *src, size_t bytes
+);
+
+#endif /* !HEADER_YZZHLPGFA4FVWGJCUR7XNBVIU_INCLUDED */
@@ -0,0 +1,203 @@
+/*
+ * Template for a ChaCha20 kernel which computes CC20_XN_LANES keystream
+ * blocks at once. It is included by cc20_block.c once for every supported
+ * lane count, after defining the following macros:
+ *
+ * CC20_XN_LANES: Number of blocks computed in parallel. It must be one of
+ *    the lane counts listed for LANES in cc20.sdef.
+ * CC20_XN_NAME: Name of the kernel function to be defined.
+ * CC20_XN_TARGET: Function attributes selecting the instruction set.
+ * CC20_XN_BYTE_ROTATE: Define if byte shuffles are cheaper than shifts.
+ *
+ * The kernel uses the CC20_XN_LANES-way interleaved (structure-of-arrays)
+ * layout which sdef2h generates from cc20.sdef: The vector x[k] holds state
+ * word k of all lanes, and lane n computes block number <block> + n. The
+ * initial state is assembled in that layout and loaded with the generated
+ * helpers. The result is transposed before it is combined with the data,
+ * with shuffles where available and through the layout otherwise.
+ *
+ * Version 2026.290
+ *
+ * Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+ *
+ * This source file is free software.
+ * Distribution is permitted under the terms of the GPLv3.
+ */
+
+#define CC20_XN_VEC CC20_XN_CAT(cc20_xn_vec, CC20_XN_LANES)
+#define CC20_XN_BVEC CC20_XN_CAT(cc20_xn_bvec, CC20_XN_LANES)
+
+typedef uint32_t CC20_XN_VEC
+   __attribute__((vector_size(CC20_XN_LANES * sizeof(uint32_t))));
+typedef unsigned char CC20_XN_BVEC
+   __attribute__((vector_size(CC20_XN_LANES * sizeof(uint32_t))));
+
+/* The interleaved layout for CC20_XN_LANES lanes as generated from
+ * cc20.sdef. CC20_XN_X(EACH)(M) expands M(i) for every lane i. */
+#define CC20_XN_X(name) \
+   CC20_XN_CAT(CC20_XN_CAT(CC20_X, CC20_XN_LANES), CC20_XN_CAT(_, name))
+#define CC20_XN_EACH CC20_XN_X(EACH)
+
+#ifdef HAVE_BUILTIN_SHUFFLE
+   #define CC20_XN_SHUFFLE(a, b, M) \
+      __builtin_shuffle(a, b, (CC20_XN_VEC){CC20_XN_EACH(M)})
+   /* Shuffle masks for interleaving the low or high word pairs ('L32',
+    * 'H32') or double-word pairs ('L64', 'H64') of two vectors within every
+    * group of 4 lanes. */
+   #define CC20_XN_L32(i) \
+      ((i) / 4 * 4 + (i) % 4 / 2 + (i) % 2 * CC20_XN_LANES)
+   #define CC20_XN_H32(i) (CC20_XN_L32(i) + 2)
+   #define CC20_XN_L64(i) \
+      ((i) / 4 * 4 + (i) % 2 + (i) / 2 % 2 * CC20_XN_LANES)
+   #define CC20_XN_H64(i) (CC20_XN_L64(i) + 2)
+   /* Shuffle masks for swapping the upper group of 4 or 8 lanes of the first
+    * vector with the lower group of the second vector. */
+   #define CC20_XN_SWAP_A(i, h) ((i) & (h) ? CC20_XN_LANES + (i) - (h) : (i))
+   #define CC20_XN_SWAP_B(i, h) ((i) & (h) ? CC20_XN_LANES + (i) : (i) + (h))
+   #define CC20_XN_A4(i) CC20_XN_SWAP_A(i, 4)
+   #define CC20_XN_B4(i) CC20_XN_SWAP_B(i, 4)
+   #define CC20_XN_A8(i) CC20_XN_SWAP_A(i, 8)
+   #define CC20_XN_B8(i) CC20_XN_SWAP_B(i, 8)
+   #ifdef CC20_XN_BYTE_ROTATE
+      #define CC20_XN_R16(i) 4 * (i) + 2, 4 * (i) + 3, 4 * (i), 4 * (i) + 1
+      #define CC20_XN_R8(i) 4 * (i) + 3, 4 * (i), 4 * (i) + 1, 4 * (i) + 2
+      #define CC20_XN_ROTL(v, n) ( \
+         (n) % 8 ? ROTL32(v, n) : (CC20_XN_VEC)__builtin_shuffle( \
+            (CC20_XN_BVEC)(v), \
+            (n) == 16 \
+               ? (CC20_XN_BVEC){CC20_XN_EACH(CC20_XN_R16)} \
+               : (CC20_XN_BVEC){CC20_XN_EACH(CC20_XN_R8)} \
+         ) \
+      )
+   #endif
+#endif
+#ifndef CC20_XN_ROTL
+   #define CC20_XN_ROTL ROTL32
+#endif
+
+static CC20_XN_TARGET void CC20_XN_NAME(
+   uint32_t const *state, unsigned rounds, uint64_t block,
+   unsigned char *dst, unsigned char const *src, size_t groups
+) {
+   CC20_XN_VEC in[16];
+   unsigned k, n;
+   {
+      /* The initial state of all lanes in the interleaved layout. */
+      uint32_t soa[CC20_XN_X(LENGTH_O)];
+      for (k = 16; k--; ) {
+         for (n = CC20_XN_LANES; n--; ) soa[CC20_XN_X(AT)(k, n)] = state[k];
+      }
+      for (n = CC20_XN_LANES; n--; ) {
+         uint64_t pos = block + n;
+         soa[CC20_XN_X(AT)(CC20_POS_O, n)] = (uint32_t)pos;
+         soa[CC20_XN_X(AT)(CC20_POS_O + 1, n)] = (uint32_t)(pos >> 32);
+      }
+      for (k = 16; k--; ) { CC20_XN_X(LOAD)(in[k], soa, k); }
+   }
+   while (groups--) {
+      CC20_XN_VEC x[16];
+      for (k = 16; k--; ) x[k] = in[k];
+      for (k = rounds / 2; k--; ) { DOUBLE_ROUND(CC20_XN_ROTL, x); }
+      for (k = 16; k--; ) x[k] += in[k];
+      #ifdef HAVE_BUILTIN_SHUFFLE
+      {
+         /* Transpose every group of CC20_XN_LANES state words. First
+          * transpose all 4 x 4 sub-matrices in place, then swap them across
+          * the diagonal. Afterwards x[g + n] holds the words g and
+          * following of block n. */
+         unsigned g, r;
+         for (g = 0; g < 16; g += CC20_XN_LANES) {
+            CC20_XN_VEC *m = x + g;
+            for (r = 0; r < CC20_XN_LANES; r += 4) {
+               CC20_XN_VEC t0, t1, t2, t3;
+               t0 = CC20_XN_SHUFFLE(m[r], m[r + 1], CC20_XN_L32);
+               t1 = CC20_XN_SHUFFLE(m[r], m[r + 1], CC20_XN_H32);
+               t2 = CC20_XN_SHUFFLE(m[r + 2], m[r + 3], CC20_XN_L32);
+               t3 = CC20_XN_SHUFFLE(m[r + 2], m[r + 3], CC20_XN_H32);
+               m[r] = CC20_XN_SHUFFLE(t0, t2, CC20_XN_L64);
+               m[r + 1] = CC20_XN_SHUFFLE(t0, t2, CC20_XN_H64);
+               m[r + 2] = CC20_XN_SHUFFLE(t1, t3, CC20_XN_L64);
+               m[r + 3] = CC20_XN_SHUFFLE(t1, t3, CC20_XN_H64);
+            }
+            #if CC20_XN_LANES >= 8
+               for (r = 0; r < CC20_XN_LANES; ++r) {
+                  CC20_XN_VEC a, b;
+                  if (r & 4) continue;
+                  a = m[r]; b = m[r + 4];
+                  m[r] = CC20_XN_SHUFFLE(a, b, CC20_XN_A4);
+                  m[r + 4] = CC20_XN_SHUFFLE(a, b, CC20_XN_B4);
+               }
+            #endif
+            #if CC20_XN_LANES >= 16
+               for (r = 0; r < 8; ++r) {
+                  CC20_XN_VEC a = m[r], b = m[r + 8];
+                  m[r] = CC20_XN_SHUFFLE(a, b, CC20_XN_A8);
+                  m[r + 8] = CC20_XN_SHUFFLE(a, b, CC20_XN_B8);
+               }
+            #endif
+            for (n = 0; n < CC20_XN_LANES; ++n) {
+               CC20_XN_VEC w;
+               size_t o = n * CC20_BLOCK_SIZE + g * sizeof(uint32_t);
+               (void)memcpy(&w, src + o, sizeof w);
+               #ifdef WORDS_BIGENDIAN
+                  {
+                     unsigned i;
+                     for (i = CC20_XN_LANES; i--; ) m[n][i] = LE32(m[n][i]);
+                  }
+               #endif
+               w ^= m[n];
+               (void)memcpy(dst + o, &w, sizeof w);
+            }
+         }
+         src += CC20_BLOCK_SIZE * CC20_XN_LANES;
+         dst += CC20_BLOCK_SIZE * CC20_XN_LANES;
+      }
+      #else
+      {
+         /* Store the keystream in the interleaved layout and transpose
+          * while combining: Lane n provides the n-th block. */
+         uint32_t ks[CC20_XN_X(LENGTH_O)];
+         for (k = 16; k--; ) { CC20_XN_X(STORE)(ks, k, x[k]); }
+         for (n = 0; n < CC20_XN_LANES; ++n) {
+            for (k = 0; k < 16; ++k) {
+               uint32_t w;
+               (void)memcpy(&w, src, sizeof w);
+               w ^= LE32(ks[CC20_XN_X(AT)(k, n)]);
+               (void)memcpy(dst, &w, sizeof w);
+               src += sizeof w; dst += sizeof w;
+            }
+         }
+      }
+      #endif
+      {
+         /* Advance every lane by CC20_XN_LANES blocks. The comparison
+          * yields -1 for every lane which had a carry. */
+         CC20_XN_VEC pos = in[CC20_POS_O] + CC20_XN_LANES;
+         in[CC20_POS_O + 1] -= (CC20_XN_VEC)(pos < in[CC20_POS_O]);
+         in[CC20_POS_O] = pos;
+      }
+   }
+}
+
+#undef CC20_XN_ROTL
+#ifdef HAVE_BUILTIN_SHUFFLE
+   #ifdef CC20_XN_BYTE_ROTATE
+      #undef CC20_XN_R8
+      #undef CC20_XN_R16
+   #endif
+   #undef CC20_XN_B8
+   #undef CC20_XN_A8
+   #undef CC20_XN_B4
+   #undef CC20_XN_A4
+   #undef CC20_XN_SWAP_B
+   #undef CC20_XN_SWAP_A
+   #undef CC20_XN_H64
+   #undef CC20_XN_L64
+   #undef CC20_XN_H32
+   #undef CC20_XN_L32
+   #undef CC20_XN_SHUFFLE
+#endif
+#undef CC20_XN_EACH
+#undef CC20_XN_X
+#undef CC20_XN_BVEC
+#undef CC20_XN_VEC
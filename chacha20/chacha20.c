@@ -1,6 +1,6 @@
 static char version[] = {
-   "{APP} Version 2024.66\n"
-   "Copyright (c) 2023-2024 Guenther Brunthaler. All rights reserved."
+   "{APP} Version 2026.290\n"
+   "Copyright (c) 2023-2026 Guenther Brunthaler. All rights reserved."
    "\n"
    "This source file is free software.\n"
    "Distribution is permitted under the terms of the GPLv3.\n"
@@ -9,6 +9,8 @@ static char version[] = {
 static char help[] = {
    "A ChaCha20 encryption/decryption utility.\n"
    "\n"
+   "Usage: {APP} [ <options> ]\n"
+   "\n"
    "{APP} encrypts or decrypts arbitrary data read from standard input "
    "using the ChaCha20 encryption algorithm and writes the result to "
    "standard output.\n"
@@ -16,9 +18,10 @@ static char help[] = {
    "Before the data to be encrypted or decrypted, the following encryption "
    "parameters will be read from standard input:\n"
    "\n"
+   "[ 'R' <1 octet number of rounds> ]\n"
    "[ 'P' <8 octets starting offset> ]\n"
    "'K' <32 octets binary encryption key>\n"
-   "'N' <32 octets binary nonce>\n"
+   "'N' <8 octets binary nonce>\n"
    "'D' <the data to be encrypted/decrypted> ...\n"
    "\n"
    "where the characters between the quotes must be specified as-is in ASCII "
@@ -45,9 +48,91 @@ static char help[] = {
    "data read from standard input. Instead it means that this data has been "
    "extracted from a larger data stream by the user starting at the "
    "specified 64-bit-block offset.\n"
+   "\n"
+   "The optional 'R' sequence selects a reduced-round variant of the "
+   "cipher. The octet following it must have the binary value 8, 12 or 20 "
+   "for ChaCha8, ChaCha12 or ChaCha20, respectively. If omitted, the "
+   "standard 20 rounds will be used. The reduced-round variants are "
+   "significantly faster but have a smaller security margin. Data must be "
+   "decrypted with the same number of rounds as it has been encrypted "
+   "with.\n"
+   "\n"
+   "Supported options:\n"
+   "\n"
+   "-j <threads>: Use <threads> worker threads for encryption or "
+   "decryption. The input will be split into slices of 1 MiB which are "
+   "processed concurrently, and the processed slices will be written in "
+   "their original order. The output is exactly the same as without this "
+   "option. Reading and writing are done by separate threads, as with "
+   "-d.\n"
+   "\n"
+   "-d <depth>: Overlap reading, encryption and writing using separate "
+   "threads and a ring of <depth> slices of 1 MiB, at least 3. This hides "
+   "I/O latency of slow disks or network file systems. A larger <depth> "
+   "absorbs larger variations in I/O speed. The default with -j is 2 "
+   "slices per worker thread plus 2.\n"
+   "\n"
+   "-f <file>: Encrypt or decrypt <file> in place rather than standard "
+   "input. Only the parameters up to and including the nonce will be read "
+   "from standard input then. <file> is considered to be the larger data "
+   "stream mentioned above, which means that file offset 0 corresponds to "
+   "the start of the block specified with 'P'. This allows "
+   "random access to individual records of large encrypted files.\n"
+   "\n"
+   "-r <offset>[:<length>]: Together with -f, only process <length> octets "
+   "starting at file offset <offset>. If <length> is omitted, the range "
+   "extends to the end of the file. The offset need not be a multiple of "
+   "the block size. The range must not extend beyond the end of the file. "
+   "Both numbers are decimal. By default, the whole file is processed.\n"
+   "\n"
+   "-x: Together with -f, write the processed range to standard output "
+   "instead of modifying <file>. This extracts a range from an encrypted "
+   "file without decrypting anything else. -j has no effect then.\n"
+   "\n"
+   "-a: Authenticated encryption. A Poly1305 tag of 16 octets is computed "
+   "over the ciphertext in the same pass and appended to the output. The "
+   "one-time Poly1305 key is taken from the keystream block at the starting "
+   "offset, and the data is encrypted starting with the next block. With a "
+   "starting offset of 0, this is the AEAD construction of RFC 8439 with "
+   "the nonce prefixed by 4 zero octets and without additional data.\n"
+   "\n"
+   "-A: Authenticated decryption of the output of -a. The tag at the end of "
+   "the input is verified, and the program fails without releasing any "
+   "plaintext if it does not match. Decryption only starts after "
+   "verification, by re-reading the input if it is a regular file, or from "
+   "a temporary copy of the ciphertext if not. -j has no effect together "
+   "with -a or -A.\n"
+   "\n"
+   "-G <octets>: Keystream generator mode. Read only the parameters up to "
+   "and including the nonce, and write <octets> pseudorandom octets to "
+   "standard output. The keystream is generated in chunks of 1 MiB. The "
+   "first 32 octets of every chunk are not output but replace the key for "
+   "the next chunk. This makes earlier output unrecoverable even if the "
+   "program state should be compromised later. Seeded once with a random "
+   "key, this generates salts, nonces and keys without blocking.\n"
+   "\n"
+   "-b: Batch mode. Process a sequence of independent records until the "
+   "end of standard input, and write the concatenated results to standard "
+   "output. This avoids starting a new process for every message. Each "
+   "record has the same format as the parameters described above, except "
+   "that the 'D' sequence is preceded by\n"
+   "\n"
+   "'L' <8 octets data length>\n"
+   "\n"
+   "in big endian byte order, and the data following 'D' must have exactly "
+   "that length. The output for a record is flushed as soon as no more "
+   "input is pending. -j has no effect in batch mode.\n"
+   "\n"
+   "-v: Write statistics about the duration of the phases of the program "
+   "and about its I/O to standard error when it exits. Setting the "
+   "environment variable SIMPENC_STATS to anything but an empty string or "
+   "\"0\" does the same.\n"
+   "\n"
+   "-h: Display this help and exit.\n"
 };
 
-#define IO_BUFFER_SIZE (1u << 16)
+#define IO_BUFFER_SIZE (1u << 20)
+#define SERIAL_BUFFERS 4
 
 #if !defined __STDC_VERSION__ || __STDC_VERSION__ < 199901
    #error "This source file requires a C99 compliant C compiler!"
@@ -72,10 +157,63 @@ static char help[] = {
 #ifdef HAVE_UNISTD_H
    #include <unistd.h>
 #endif
+#ifdef HAVE_PTHREAD_H
+   #include <pthread.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+   #include <sys/stat.h>
+#endif
+#ifdef HAVE_FCNTL_H
+   #include <fcntl.h>
+#endif
+#ifdef HAVE_MMAP
+   #include <sys/mman.h>
+#endif
+#ifdef HAVE_VMSPLICE
+   #include <sys/uio.h>
+#endif
+#ifdef HAVE_POLL_H
+   #include <poll.h>
+#endif
+#include "cc20_block.h"
+#include "poly1305.h"
+#include "stats.h"
+
+#include "cc20_struct.h"
+
+#if defined HAVE_MMAP && defined HAVE_SYS_STAT_H
+   #define ZC_INPUT
+#endif
+#if defined HAVE_SYS_STAT_H && defined HAVE_FCNTL_H
+   #define ZC_OUTPUT
+   #if defined HAVE_PREAD && defined HAVE_PWRITE
+      #define FILE_MODE
+   #endif
+#endif
 
 static void *buffer;
 
+/* Data source. If standard input is a regular file, all of the remaining
+ * data is memory-mapped. Otherwise <map> is null and stdio will be used. */
+static struct {
+   unsigned char const *map;
+   void *base;
+   size_t size, mapped, pos;
+} in;
+
+/* Data sink. Regular files will be written with pwrite() and pipes with
+ * vmsplice(). Everything else uses stdio. */
+static struct {
+   enum {out_stdio, out_pwrite, out_vmsplice} method;
+   #ifdef ZC_OUTPUT
+      off_t pos;
+   #endif
+} out;
+
 static void release_resources(void) {
+   #ifdef ZC_INPUT
+      if (in.base) (void)munmap(in.base, in.mapped);
+   #endif
    free(buffer);
 }
 
@@ -103,12 +241,17 @@ static void write_error(void) {
 }
 
 static void write_ck(void const *src, size_t bytes) {
+   uint64_t const t0 = stats_io_begin();
    if (fwrite(src, sizeof(char), bytes, stdout) != bytes) write_error();
+   stats_write(bytes, t0);
 }
 
 static size_t try_read_ck(void *dst, size_t bytes) {
    size_t read;
-   if ((read = fread(dst, sizeof(char), bytes, stdin)) != bytes) {
+   uint64_t const t0 = stats_io_begin();
+   read = fread(dst, sizeof(char), bytes, stdin);
+   stats_read(read, t0);
+   if (read != bytes) {
       if (ferror(stdin)) io_die("Read error");
       assert(feof(stdin));
    }
@@ -239,6 +382,7 @@ static void raise_read_error(void) {
 static int getchar_ck(void) {
    int c;
    if ((c = getchar()) == EOF) raise_read_error();
+   stats_read(1, 0);
    return c;
 }
 
@@ -251,7 +395,9 @@ static void expect(int c) {
 }
 
 static void read_ck(void *dst, size_t bytes) {
+   uint64_t const t0 = stats_io_begin();
    if (fread(dst, sizeof(char), bytes, stdin) != bytes) raise_read_error();
+   stats_read(bytes, t0);
 }
 
 #ifdef WORDS_BIGENDIAN
@@ -280,32 +426,201 @@ static void read_ck(void *dst, size_t bytes) {
    }
 #endif
 
-int main(int argc, char **argv) {
-   static uint32_t state[16];
-   #include "cc20_struct.h"
-   assert(CC20_LENGTH_O == sizeof state / sizeof *state);
-   if (argc > 1) exit_usage(argc ? argv[0] : "(unnamed_program)");
-   {
-      static char const as_good_as_any[] = {"expand 32-byte k"};
-      deserialize_w32(state + CC20_CONST_O, CC20_CONST_N, as_good_as_any);
+/* Map the rest of standard input into memory if it is a regular file.
+ * Must be called after the header has been read via stdio. */
+static void input_init(void) {
+   #ifdef ZC_INPUT
+      struct stat st;
+      off_t start, aligned;
+      long page;
+      if (fstat(STDIN_FILENO, &st) || !S_ISREG(st.st_mode)) return;
+      if ((start = ftello(stdin)) < 0 || st.st_size <= start) return;
+      if ((page = sysconf(_SC_PAGESIZE)) <= 0) return;
+      aligned = start - start % page;
+      if ((uintmax_t)(st.st_size - aligned) > SIZE_MAX) {
+         /* Too large for the address space. */
+         return;
+      }
+      in.mapped = (size_t)(st.st_size - aligned);
+      if (
+         (in.base = mmap(
+            0, in.mapped, PROT_READ, MAP_PRIVATE, STDIN_FILENO, aligned
+         )) == MAP_FAILED
+      ) {
+         in.base = 0; in.mapped = 0;
+         return;
+      }
+      #ifdef HAVE_MADVISE
+         (void)madvise(in.base, in.mapped, MADV_SEQUENTIAL);
+      #endif
+      in.map = (unsigned char const *)in.base + (start - aligned);
+      in.size = (size_t)(st.st_size - start);
+   #endif
+}
+
+/* Provide up to <bytes> octets of input, which will be less only at the
+ * end of the input. <*data> is set to point to the octets which are either
+ * read into <buf> or part of the memory-mapped input. */
+static size_t input_next(
+   unsigned char const **data, unsigned char *buf, size_t bytes
+) {
+   if (in.map) {
+      if (bytes > in.size - in.pos) bytes = in.size - in.pos;
+      *data = in.map + in.pos;
+      in.pos += bytes;
+      /* Page faults are not I/O calls, but count the octets anyway. */
+      if (bytes) stats_read(bytes, 0);
+      return bytes;
    }
-   {
-      int c;
-      if ((c = getchar_ck()) == 'P') {
-         {
-            uint32_t w[CC20_POS_N];
-            read_ck(w, CC20_POS_N * sizeof *w);
-            #ifdef WORDS_BIGENDIAN
-               deserialize_w32(state + CC20_POS_O, 1, w + 1);
-               deserialize_w32(state + CC20_POS_O + 1, 1, w);
-            #else
-               deserialize_w32(state + CC20_POS_O, CC20_POS_N, w);
+   *data = buf;
+   return try_read_ck(buf, bytes);
+}
+
+/* Select the fastest way to write to standard output. <reuse_distance> is
+ * the minimum number of octets which will be output between two outputs
+ * from the same buffer memory. vmsplice() hands the memory pages over to
+ * the pipe instead of copying them, so a buffer must not be overwritten
+ * before the reader has consumed it. Which is guaranteed only if more
+ * octets than the pipe can hold have been written since then. */
+static void output_init(size_t reuse_distance) {
+   #ifdef ZC_OUTPUT
+      struct stat st;
+      int flags;
+      if (
+         fstat(STDOUT_FILENO, &st)
+         || (flags = fcntl(STDOUT_FILENO, F_GETFL)) == -1
+      ) {
+         return;
+      }
+      #ifdef HAVE_PWRITE
+         if (S_ISREG(st.st_mode) && !(flags & O_APPEND)) {
+            if ((out.pos = lseek(STDOUT_FILENO, 0, SEEK_CUR)) >= 0) {
+               out.method = out_pwrite;
+            }
+            return;
+         }
+      #endif
+      #if defined HAVE_VMSPLICE && defined F_GETPIPE_SZ
+         if (S_ISFIFO(st.st_mode) && !(flags & O_NONBLOCK)) {
+            int size;
+            #ifdef F_SETPIPE_SZ
+               /* Larger pipes mean fewer context switches. */
+               (void)fcntl(STDOUT_FILENO, F_SETPIPE_SZ, (int)IO_BUFFER_SIZE);
             #endif
+            if (
+               (size = fcntl(STDOUT_FILENO, F_GETPIPE_SZ)) > 0
+               && (size_t)size <= reuse_distance
+            ) {
+               out.method = out_vmsplice;
+            }
          }
-         expect('K');
-      } else if (c != 'K') {
-         die_expecting('K');
+      #endif
+   #else
+      (void)reuse_distance;
+   #endif
+}
+
+static void output_ck(unsigned char const *data, size_t bytes) {
+   switch (out.method) {
+      #ifdef ZC_OUTPUT
+         ssize_t written;
+         uint64_t t0;
+      #endif
+      #ifdef HAVE_PWRITE
+         case out_pwrite:
+            while (bytes) {
+               t0 = stats_io_begin();
+               written = pwrite(STDOUT_FILENO, data, bytes, out.pos);
+               if (written <= 0) {
+                  if (written && errno == EINTR) continue;
+                  write_error();
+               }
+               data += written; bytes -= (size_t)written; out.pos += written;
+               stats_write((size_t)written, t0);
+            }
+            break;
+      #endif
+      #ifdef HAVE_VMSPLICE
+         case out_vmsplice:
+            while (bytes) {
+               struct iovec iov;
+               t0 = stats_io_begin();
+               iov.iov_base = (void *)data; iov.iov_len = bytes;
+               written = vmsplice(STDOUT_FILENO, &iov, 1, 0);
+               if (written <= 0) {
+                  if (written && errno == EINTR) continue;
+                  write_error();
+               }
+               data += written; bytes -= (size_t)written;
+               stats_write((size_t)written, t0);
+            }
+            break;
+      #endif
+      default:
+         assert(out.method == out_stdio);
+         write_ck(data, bytes);
+   }
+}
+
+static void output_finish(void) {
+   #ifdef HAVE_PWRITE
+      /* Leave the file offset where stdio would have left it. */
+      if (out.method == out_pwrite) {
+         if (lseek(STDOUT_FILENO, out.pos, SEEK_SET) < 0) write_error();
       }
+   #endif
+}
+
+static void crypt_serial(
+   uint32_t const *state, unsigned rounds, uint64_t pos
+) {
+   size_t bytes;
+   unsigned i = 0;
+   assert(!buffer);
+   buffer = malloc_ck(SERIAL_BUFFERS * IO_BUFFER_SIZE);
+   output_init((SERIAL_BUFFERS - 1) * IO_BUFFER_SIZE);
+   assert(IO_BUFFER_SIZE % CC20_BLOCK_SIZE == 0);
+   for (;;) {
+      unsigned char *dst = (unsigned char *)buffer + i * IO_BUFFER_SIZE;
+      unsigned char const *src;
+      if (!(bytes = input_next(&src, dst, IO_BUFFER_SIZE))) break;
+      cc20_xor(state, rounds, pos, dst, src, bytes);
+      pos += IO_BUFFER_SIZE / CC20_BLOCK_SIZE;
+      output_ck(dst, bytes);
+      i = (i + 1) % SERIAL_BUFFERS;
+   }
+}
+
+/* Read an unsigned 64-bit number in big endian byte order. */
+static uint64_t read_be64(void) {
+   unsigned char o[8];
+   uint64_t v = 0;
+   unsigned i;
+   read_ck(o, sizeof o);
+   for (i = 0; i < sizeof o; ++i) v = v << 8 | o[i];
+   return v;
+}
+
+/* Read the parameters from 'R' up to and including the nonce into
+ * <state>, <*rounds> and <*pos>. <c> is the first character of the header
+ * which has already been read. */
+static void read_header(
+   int c, uint32_t *state, unsigned *rounds, uint64_t *pos
+) {
+   *rounds = 20; *pos = 0;
+   if (c == 'R') {
+      switch (*rounds = (unsigned)getchar_ck()) {
+         case 8: case 12: case 20: break;
+         default: die("Unsupported number of rounds: %u!", *rounds);
+      }
+      c = getchar_ck();
+   }
+   if (c == 'P') {
+      assert(CC20_POS_N * sizeof *state == sizeof *pos);
+      *pos = read_be64();
+      expect('K');
+   } else if (c != 'K') {
+      die_expecting('K');
    }
    {
       uint32_t w[CC20_KEY_N];
@@ -318,14 +633,707 @@ int main(int argc, char **argv) {
       read_ck(w, CC20_NONCE_N * sizeof *w);
       deserialize_w32(state + CC20_NONCE_O, CC20_NONCE_N, w);
    }
-   expect('D');
+}
+
+/* Whether more input can be read without blocking. If in doubt, 0 is
+ * returned. */
+static int input_pending(void) {
+   #ifdef HAVE_POLL_H
+      struct pollfd p;
+      p.fd = STDIN_FILENO; p.events = POLLIN;
+      return poll(&p, 1, 0) == 1;
+   #else
+      return 0;
+   #endif
+}
+
+/* Process a sequence of independent records until the end of the input.
+ * The output of every record is made available to the reader as soon as
+ * no more input is pending, so that request/response style clients work
+ * without the cost of flushing the output after every record. */
+static void crypt_batch(uint32_t *state) {
+   int c;
+   assert(!buffer);
    buffer = malloc_ck(IO_BUFFER_SIZE);
-   {
-      size_t bytes;
-      while (bytes = try_read_ck(buffer, IO_BUFFER_SIZE)) {
+   while ((c = getchar()) != EOF) {
+      unsigned rounds;
+      uint64_t pos, length;
+      stats_phase("header");
+      read_header(c, state, &rounds, &pos);
+      expect('L');
+      length = read_be64();
+      expect('D');
+      stats_phase("bulk");
+      while (length) {
+         size_t bytes =
+            length < IO_BUFFER_SIZE ? (size_t)length : IO_BUFFER_SIZE
+         ;
+         read_ck(buffer, bytes);
+         cc20_xor(state, rounds, pos, buffer, buffer, bytes);
          write_ck(buffer, bytes);
+         pos += IO_BUFFER_SIZE / CC20_BLOCK_SIZE;
+         length -= bytes;
+      }
+      if (!input_pending() && fflush(stdout)) write_error();
+   }
+   if (ferror(stdin)) raise_read_error();
+}
+
+/* Overwrite sensitive data in a way the compiler will not optimize away. */
+static void wipe(void *data, size_t bytes) {
+   volatile unsigned char *p = data;
+   while (bytes--) *p++ = 0;
+}
+
+/* Set up <mac> using the keystream block <pos> as the one-time key. */
+static void mac_init(
+   struct poly1305 *mac, uint32_t const *state, unsigned rounds, uint64_t pos
+) {
+   unsigned char k[CC20_BLOCK_SIZE];
+   (void)memset(k, 0, sizeof k);
+   cc20_xor(state, rounds, pos, k, k, sizeof k);
+   assert(POLY1305_KEY_SIZE <= sizeof k);
+   poly1305_init(mac, k);
+   wipe(k, sizeof k);
+}
+
+/* Finish <mac> after <length> octets of ciphertext as in RFC 8439: Pad to
+ * a multiple of 16 octets and append the lengths of the (empty) additional
+ * data and of the ciphertext. */
+static void mac_finish(
+   struct poly1305 *mac, uint64_t length, unsigned char *tag
+) {
+   unsigned char tail[16 + 16];
+   size_t padding = (size_t)(16 - length % 16) % 16;
+   unsigned i;
+   (void)memset(tail, 0, sizeof tail);
+   for (i = 0; i < 8; ++i) {
+      tail[padding + 8 + i] = (unsigned char)(length >> 8 * i);
+   }
+   poly1305_update(mac, tail, padding + 16);
+   poly1305_finish(mac, tag);
+}
+
+/* vmsplice() requires the tag to stay unmodified after it has been
+ * output. */
+static unsigned char auth_tag[POLY1305_TAG_SIZE];
+
+static void crypt_seal(uint32_t const *state, unsigned rounds, uint64_t pos) {
+   struct poly1305 mac;
+   uint64_t length = 0;
+   size_t bytes;
+   unsigned i = 0;
+   mac_init(&mac, state, rounds, pos++);
+   assert(!buffer);
+   buffer = malloc_ck(SERIAL_BUFFERS * IO_BUFFER_SIZE);
+   output_init((SERIAL_BUFFERS - 1) * IO_BUFFER_SIZE);
+   for (;;) {
+      unsigned char *dst = (unsigned char *)buffer + i * IO_BUFFER_SIZE;
+      unsigned char const *src;
+      if (!(bytes = input_next(&src, dst, IO_BUFFER_SIZE))) break;
+      cc20_xor(state, rounds, pos, dst, src, bytes);
+      poly1305_update(&mac, dst, bytes);
+      output_ck(dst, bytes);
+      pos += IO_BUFFER_SIZE / CC20_BLOCK_SIZE;
+      length += bytes;
+      i = (i + 1) % SERIAL_BUFFERS;
+   }
+   mac_finish(&mac, length, auth_tag);
+   output_ck(auth_tag, sizeof auth_tag);
+}
+
+static void crypt_open(uint32_t const *state, unsigned rounds, uint64_t pos) {
+   /* Every buffer has room for the tag after the data, because the tag
+    * can only be recognized as such at the end of the input. */
+   size_t const stride = IO_BUFFER_SIZE + POLY1305_TAG_SIZE;
+   struct poly1305 mac;
+   unsigned char tag[POLY1305_TAG_SIZE];
+   uint64_t const start = ++pos;
+   uint64_t length = 0;
+   FILE *spill = 0;
+   size_t bytes, held = 0;
+   unsigned i = 0;
+   int eof = 0;
+   mac_init(&mac, state, rounds, start - 1);
+   assert(!buffer);
+   buffer = malloc_ck(SERIAL_BUFFERS * stride);
+   output_init((SERIAL_BUFFERS - 1) * stride);
+   /* The first pass only verifies, so that no plaintext is output before
+    * the tag has been checked. */
+   stats_phase("verify");
+   if (in.map) {
+      if (in.size < sizeof tag) die("Missing authentication tag!");
+      in.size -= sizeof tag;
+      (void)memcpy(tag, in.map + in.size, sizeof tag);
+   } else if (!(spill = tmpfile())) {
+      io_die("Could not create temporary file");
+   }
+   while (!eof) {
+      unsigned char *dst = (unsigned char *)buffer + i * stride;
+      unsigned char const *src;
+      if (in.map) {
+         bytes = input_next(&src, dst, IO_BUFFER_SIZE);
+         eof = bytes < IO_BUFFER_SIZE;
+      } else {
+         /* <held> octets from the end of the previous buffer are already
+          * at the beginning of <dst>. Always keep the last octets read
+          * back, because they might be the tag. */
+         bytes = held + try_read_ck(dst + held, stride - held);
+         if (eof = bytes < stride) {
+            if (bytes < sizeof tag) die("Missing authentication tag!");
+            bytes -= sizeof tag;
+            (void)memcpy(tag, dst + bytes, sizeof tag);
+         } else {
+            bytes = IO_BUFFER_SIZE;
+            held = stride - bytes;
+            (void)memcpy(
+               (unsigned char *)buffer + (i + 1) % SERIAL_BUFFERS * stride,
+               dst + bytes, held
+            );
+         }
+         src = dst;
+      }
+      poly1305_update(&mac, src, bytes);
+      length += bytes;
+      if (spill && fwrite(src, sizeof(char), bytes, spill) != bytes) {
+         io_die("Could not write temporary file");
+      }
+      i = (i + 1) % SERIAL_BUFFERS;
+   }
+   {
+      unsigned char expected[sizeof tag];
+      mac_finish(&mac, length, expected);
+      if (!poly1305_verify(expected, tag)) die("Authentication failed!");
+   }
+   stats_phase("bulk");
+   /* Verified - now decrypt for real. */
+   if (spill && fseek(spill, 0, SEEK_SET)) {
+      io_die("Could not rewind temporary file");
+   }
+   in.pos = 0; pos = start; i = 0;
+   for (;;) {
+      unsigned char *dst = (unsigned char *)buffer + i * stride;
+      unsigned char const *src = dst;
+      if (spill) {
+         if (!(bytes = fread(dst, sizeof(char), IO_BUFFER_SIZE, spill))) {
+            if (ferror(spill)) io_die("Could not read temporary file");
+            break;
+         }
+      } else if (!(bytes = input_next(&src, dst, IO_BUFFER_SIZE))) {
+         break;
+      }
+      cc20_xor(state, rounds, pos, dst, src, bytes);
+      output_ck(dst, bytes);
+      pos += IO_BUFFER_SIZE / CC20_BLOCK_SIZE;
+      i = (i + 1) % SERIAL_BUFFERS;
+   }
+   if (spill) (void)fclose(spill);
+}
+
+/* Write <octets> octets of keystream, re-keying after every buffer by
+ * replacing the key with the first keystream octets of that buffer, which
+ * are not output. Compromising the state therefore does not reveal any
+ * earlier output ("fast key erasure"). */
+static void generate(
+   uint32_t *state, unsigned rounds, uint64_t pos, uint64_t octets
+) {
+   size_t const rekey = CC20_KEY_N * sizeof *state;
+   unsigned i = 0;
+   assert(!buffer);
+   buffer = malloc_ck(SERIAL_BUFFERS * IO_BUFFER_SIZE);
+   output_init((SERIAL_BUFFERS - 1) * IO_BUFFER_SIZE);
+   while (octets) {
+      unsigned char *ks = (unsigned char *)buffer + i * IO_BUFFER_SIZE;
+      size_t bytes = IO_BUFFER_SIZE - rekey, blocks;
+      if (octets < bytes) bytes = (size_t)octets;
+      blocks = (rekey + bytes + CC20_BLOCK_SIZE - 1) / CC20_BLOCK_SIZE;
+      (void)memset(ks, 0, blocks * CC20_BLOCK_SIZE);
+      cc20_xor(state, rounds, pos, ks, ks, blocks * CC20_BLOCK_SIZE);
+      deserialize_w32(state + CC20_KEY_O, CC20_KEY_N, ks);
+      wipe(ks, rekey);
+      output_ck(ks + rekey, bytes);
+      octets -= bytes;
+      i = (i + 1) % SERIAL_BUFFERS;
+   }
+   wipe(state + CC20_KEY_O, rekey);
+}
+
+#ifdef HAVE_PTHREAD_H
+   /* State shared between the reader thread, which fills the ring of slices
+    * in order, the worker threads, which encrypt them, and the main thread,
+    * which writes them in order. A slice moves through the states queued ->
+    * busy -> done -> free. <produced> counts the slices queued by the reader
+    * so far, and <eof> is set after it has queued the last one. */
+   static struct {
+      pthread_mutex_t lock;
+      pthread_cond_t queued, done, freed;
+      uint32_t const *state;
+      unsigned rounds;
+      uint64_t pos;
+      struct mt_slice {
+         unsigned char *data;
+         unsigned char const *src;
+         size_t bytes;
+         uint64_t block;
+         enum {slice_free, slice_queued, slice_busy, slice_done} status;
+      } *slices;
+      unsigned nslices, next_job;
+      uint64_t produced;
+      int quit, eof;
+   } mt = {
+      PTHREAD_MUTEX_INITIALIZER,
+      PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+      PTHREAD_COND_INITIALIZER
+   };
+
+   static void mt_ck(int error, char const *eprefix) {
+      if (error) {
+         errno = error;
+         io_die(eprefix);
+      }
+   }
+
+   static void mt_lock(void) {
+      mt_ck(pthread_mutex_lock(&mt.lock), "Could not lock mutex");
+   }
+
+   static void mt_unlock(void) {
+      mt_ck(pthread_mutex_unlock(&mt.lock), "Could not unlock mutex");
+   }
+
+   static void mt_wait(pthread_cond_t *cond) {
+      mt_ck(pthread_cond_wait(cond, &mt.lock), "Could not wait for thread");
+   }
+
+   static void *mt_worker(void *unused) {
+      (void)unused;
+      mt_lock();
+      for (;;) {
+         struct mt_slice *s = mt.slices + mt.next_job;
+         if (s->status != slice_queued) {
+            if (mt.quit) break;
+            mt_wait(&mt.queued);
+            continue;
+         }
+         s->status = slice_busy;
+         mt.next_job = (mt.next_job + 1) % mt.nslices;
+         mt_unlock();
+         cc20_xor(
+            mt.state, mt.rounds, s->block, s->data, s->src, s->bytes
+         );
+         mt_lock();
+         s->status = slice_done;
+         mt_ck(pthread_cond_broadcast(&mt.done), "Could not signal thread");
+      }
+      mt_unlock();
+      return 0;
+   }
+
+   static void *mt_reader(void *unused) {
+      unsigned tail = 0;
+      uint64_t pos = mt.pos;
+      (void)unused;
+      assert(IO_BUFFER_SIZE % CC20_BLOCK_SIZE == 0);
+      for (;;) {
+         struct mt_slice *s = mt.slices + tail;
+         mt_lock();
+         while (s->status != slice_free) mt_wait(&mt.freed);
+         mt_unlock();
+         if (!(s->bytes = input_next(&s->src, s->data, IO_BUFFER_SIZE))) {
+            break;
+         }
+         s->block = pos;
+         pos += IO_BUFFER_SIZE / CC20_BLOCK_SIZE;
+         mt_lock();
+         s->status = slice_queued;
+         ++mt.produced;
+         mt_ck(pthread_cond_signal(&mt.queued), "Could not signal thread");
+         mt_unlock();
+         if (s->bytes < IO_BUFFER_SIZE) break;
+         tail = (tail + 1) % mt.nslices;
+      }
+      mt_lock();
+      mt.eof = 1;
+      mt_ck(pthread_cond_broadcast(&mt.done), "Could not signal thread");
+      mt_unlock();
+      return 0;
+   }
+
+   /* Overlap reading, encryption by <threads> workers and writing, using a
+    * ring of <depth> slices. */
+   static void crypt_pipelined(
+      uint32_t const *state, unsigned rounds, uint64_t pos,
+      unsigned threads, unsigned depth
+   ) {
+      pthread_t *workers, reader;
+      unsigned i, head = 0;
+      uint64_t written = 0;
+      struct mt_slice *pinned = 0;
+      mt.state = state; mt.rounds = rounds; mt.pos = pos;
+      assert(depth >= 3);
+      mt.nslices = depth;
+      assert(!buffer);
+      buffer = malloc_ck(
+         mt.nslices * (sizeof *mt.slices + IO_BUFFER_SIZE)
+         + threads * sizeof *workers
+      );
+      mt.slices = buffer;
+      workers = (pthread_t *)(mt.slices + mt.nslices);
+      {
+         unsigned char *data = (unsigned char *)(workers + threads);
+         for (i = 0; i < mt.nslices; ++i, data += IO_BUFFER_SIZE) {
+            mt.slices[i].data = data;
+            mt.slices[i].status = slice_free;
+         }
+      }
+      /* A slice is only freed for re-use after the next one has been
+       * written. */
+      output_init(IO_BUFFER_SIZE);
+      for (i = 0; i < threads; ++i) {
+         mt_ck(
+            pthread_create(workers + i, 0, mt_worker, 0),
+            "Could not create worker thread"
+         );
+      }
+      mt_ck(
+         pthread_create(&reader, 0, mt_reader, 0),
+         "Could not create reader thread"
+      );
+      for (;;) {
+         struct mt_slice *s = mt.slices + head;
+         mt_lock();
+         while (
+            s->status != slice_done && !(mt.eof && written == mt.produced)
+         ) {
+            mt_wait(&mt.done);
+         }
+         mt_unlock();
+         if (s->status != slice_done) break;
+         output_ck(s->data, s->bytes);
+         ++written;
+         mt_lock();
+         if (pinned) {
+            pinned->status = slice_free;
+            mt_ck(pthread_cond_signal(&mt.freed), "Could not signal thread");
+         }
+         mt_unlock();
+         pinned = s;
+         head = (head + 1) % mt.nslices;
+      }
+      mt_ck(pthread_join(reader, 0), "Could not join reader thread");
+      mt_lock();
+      mt.quit = 1;
+      mt_ck(pthread_cond_broadcast(&mt.queued), "Could not signal thread");
+      mt_unlock();
+      for (i = 0; i < threads; ++i) {
+         mt_ck(pthread_join(workers[i], 0), "Could not join worker thread");
+      }
+   }
+#endif
+
+#ifdef FILE_MODE
+   /* File mode state. The range [<next>, <end>) of file offsets remains to
+    * be processed. File offset 0 corresponds to keystream block <pos>. */
+   static struct {
+      int fd, extract;
+      uint32_t const *state;
+      unsigned rounds;
+      uint64_t pos;
+      off_t next, end;
+   } fm = {-1};
+
+   static void fm_read_ck(unsigned char *dst, size_t bytes, off_t offset) {
+      while (bytes) {
+         ssize_t got;
+         if ((got = pread(fm.fd, dst, bytes, offset)) <= 0) {
+            if (got && errno == EINTR) continue;
+            if (!got) die("File is shorter than the range to be processed!");
+            raise_read_error();
+         }
+         dst += got; bytes -= (size_t)got; offset += got;
+      }
+   }
+
+   static void fm_write_ck(
+      unsigned char const *src, size_t bytes, off_t offset
+   ) {
+      while (bytes) {
+         ssize_t written;
+         if ((written = pwrite(fm.fd, src, bytes, offset)) <= 0) {
+            if (written && errno == EINTR) continue;
+            write_error();
+         }
+         src += written; bytes -= (size_t)written; offset += written;
+      }
+   }
+
+   /* Claim the next chunk [<*start>, <*stop>) of the range. Chunks end at
+    * multiples of IO_BUFFER_SIZE, so only the first one can start in the
+    * middle of a keystream block. Returns 0 if nothing is left. */
+   static int fm_claim(off_t *start, off_t *stop) {
+      int claimed;
+      #ifdef HAVE_PTHREAD_H
+         mt_lock();
+      #endif
+      if (claimed = (*start = fm.next) < fm.end) {
+         off_t room = IO_BUFFER_SIZE - *start % IO_BUFFER_SIZE;
+         fm.next = *stop = fm.end - *start > room ? *start + room : fm.end;
+         /* Account for the I/O of the chunk here, where the lock is held
+          * anyway. Extracted chunks are accounted for by write_ck(). */
+         stats_read((size_t)(*stop - *start), 0);
+         if (!fm.extract) stats_write((size_t)(*stop - *start), 0);
+      }
+      #ifdef HAVE_PTHREAD_H
+         mt_unlock();
+      #endif
+      return claimed;
+   }
+
+   /* Process chunks until none are left. <buf> must have room for
+    * IO_BUFFER_SIZE octets. */
+   static void fm_process(unsigned char *buf) {
+      off_t start, stop;
+      while (fm_claim(&start, &stop)) {
+         /* Skip into the first keystream block by placing the data at the
+          * same offset within <buf>. The octets before it are ignored. */
+         size_t skip = (size_t)(start % CC20_BLOCK_SIZE);
+         size_t bytes = (size_t)(stop - start);
+         assert(skip + bytes <= IO_BUFFER_SIZE);
+         fm_read_ck(buf + skip, bytes, start);
+         cc20_xor(
+            fm.state, fm.rounds,
+            fm.pos + (uint64_t)(start / CC20_BLOCK_SIZE),
+            buf, buf, skip + bytes
+         );
+         if (fm.extract) {
+            write_ck(buf + skip, bytes);
+         } else {
+            fm_write_ck(buf + skip, bytes, start);
+         }
+      }
+   }
+
+   #ifdef HAVE_PTHREAD_H
+      static void *fm_worker(void *buf) {
+         fm_process(buf);
+         return 0;
+      }
+   #endif
+
+   /* Process the range [<start>, <start> + <length>) of <file>, or from
+    * <start> to the end of the file if <length> is negative. The calling
+    * thread is one of the <threads> threads. */
+   static void crypt_file(
+      uint32_t const *state, unsigned rounds, uint64_t pos, char const *file,
+      off_t start, off_t length, int extract, unsigned threads
+   ) {
+      unsigned char *data;
+      unsigned i;
+      fm.state = state; fm.rounds = rounds; fm.pos = pos;
+      fm.extract = extract;
+      if ((fm.fd = open(file, extract ? O_RDONLY : O_RDWR)) == -1) {
+         io_die(file);
+      }
+      {
+         struct stat st;
+         if (fstat(fm.fd, &st)) io_die(file);
+         if (length < 0) {
+            if ((length = st.st_size - start) < 0) length = -1;
+         } else if (start > st.st_size || length > st.st_size - start) {
+            length = -1;
+         }
+         if (length < 0) die("Range extends beyond the end of the file!");
+      }
+      fm.next = start; fm.end = start + length;
+      if (extract) threads = 1;
+      if (length / IO_BUFFER_SIZE < threads) {
+         /* There is not enough work for all threads. */
+         threads = (unsigned)(length / IO_BUFFER_SIZE) + 1;
+      }
+      assert(!buffer);
+      #ifdef HAVE_PTHREAD_H
+      {
+         pthread_t *workers;
+         buffer = malloc_ck(
+            threads * IO_BUFFER_SIZE + (threads - 1) * sizeof *workers
+         );
+         data = buffer;
+         workers = (pthread_t *)(data + threads * IO_BUFFER_SIZE);
+         for (i = 0; i < threads - 1; ++i) {
+            mt_ck(
+               pthread_create(
+                  workers + i, 0, fm_worker, data + (i + 1) * IO_BUFFER_SIZE
+               ), "Could not create worker thread"
+            );
+         }
+         fm_process(data);
+         for (i = 0; i < threads - 1; ++i) {
+            mt_ck(pthread_join(workers[i], 0), "Could not join worker thread");
+         }
+      }
+      #else
+         (void)i;
+         assert(threads == 1);
+         data = buffer = malloc_ck(IO_BUFFER_SIZE);
+         fm_process(data);
+      #endif
+      if (close(fm.fd)) {
+         fm.fd = -1;
+         io_die(file);
+      }
+      fm.fd = -1;
+   }
+#endif
+
+/* Parse a non-negative decimal file offset or length from <*text> and
+ * advance <*text> to the first character after it. */
+static off_t parse_offset(char const **text, char const *arg) {
+   unsigned long long v;
+   char *end;
+   if (
+      **text < '0' || **text > '9'
+      || ((errno = 0), v = strtoull(*text, &end, 10), errno)
+      || (off_t)v < 0 || (unsigned long long)(off_t)v != v
+   ) {
+      die("Invalid range \"%s\"!", arg);
+   }
+   *text = end;
+   return (off_t)v;
+}
+
+int main(int argc, char **argv) {
+   static uint32_t state[16];
+   uint64_t pos;
+   unsigned rounds, threads = 1, depth = 0;
+   char const *file = 0, *range = 0;
+   off_t start = 0, length = -1;
+   int extract = 0, batch = 0, auth = 0;
+   uint64_t generated = 0;
+   char const *generate_arg = 0;
+   assert(CC20_LENGTH_O == sizeof state / sizeof *state);
+   stats_init("chacha20");
+   {
+      char const *app = argc ? argv[0] : "(unnamed_program)";
+      int opt;
+      while ((opt = getopt(argc, argv, "aAbd:j:f:G:r:xvh")) != -1) {
+         switch (opt) {
+            case 'd':
+               {
+                  long n;
+                  char *end;
+                  if (
+                     (n = strtol(optarg, &end, 10)) < 3 || *end
+                     || (depth = (unsigned)n) != n
+                  ) {
+                     die("Invalid ring depth \"%s\"!", optarg);
+                  }
+               }
+               #ifndef HAVE_PTHREAD_H
+                  die("Threads are not supported!");
+               #endif
+               break;
+            case 'j':
+               {
+                  long n;
+                  char *end;
+                  if (
+                     (n = strtol(optarg, &end, 10)) < 1 || *end
+                     || (threads = (unsigned)n) != n
+                  ) {
+                     die("Invalid number of threads \"%s\"!", optarg);
+                  }
+               }
+               #ifndef HAVE_PTHREAD_H
+                  if (threads > 1) die("Threads are not supported!");
+               #endif
+               break;
+            case 'a': auth = 'a'; break;
+            case 'A': auth = 'A'; break;
+            case 'b': batch = 1; break;
+            case 'f': file = optarg; break;
+            case 'G': generate_arg = optarg; break;
+            case 'r': range = optarg; break;
+            case 'x': extract = 1; break;
+            case 'v': stats_enable(); break;
+            default: exit_usage(app);
+         }
+      }
+      if (optind < argc) exit_usage(app);
+      if (!file && (range || extract)) exit_usage(app);
+      if (batch && file || auth && (batch || file)) exit_usage(app);
+      if (generate_arg) {
+         unsigned long long n;
+         char *end;
+         if (auth || batch || file) exit_usage(app);
+         if (
+            *generate_arg < '0' || *generate_arg > '9'
+            || ((errno = 0), n = strtoull(generate_arg, &end, 10), errno)
+            || *end || (generated = n) != n
+         ) {
+            die("Invalid number of octets \"%s\"!", generate_arg);
+         }
+      }
+      #ifndef FILE_MODE
+         if (file) die("File mode is not supported!");
+      #endif
+      if (range) {
+         char const *p = range;
+         start = parse_offset(&p, range);
+         if (*p == ':') {
+            ++p;
+            length = parse_offset(&p, range);
+         }
+         if (*p) die("Invalid range \"%s\"!", range);
+      }
+   }
+   cc20_init();
+   {
+      static char const as_good_as_any[] = {"expand 32-byte k"};
+      deserialize_w32(state + CC20_CONST_O, CC20_CONST_N, as_good_as_any);
+   }
+   if (batch) {
+      crypt_batch(state);
+      if (fflush(0)) write_error();
+      release_resources();
+      return EXIT_SUCCESS;
+   }
+   stats_phase("header");
+   read_header(getchar_ck(), state, &rounds, &pos);
+   stats_phase("bulk");
+   if (generate_arg) {
+      generate(state, rounds, pos, generated);
+      output_finish();
+      if (fflush(0)) write_error();
+      release_resources();
+      return EXIT_SUCCESS;
+   }
+   #ifdef FILE_MODE
+      if (file) {
+         crypt_file(state, rounds, pos, file, start, length, extract, threads);
+         if (fflush(0)) write_error();
+         release_resources();
+         return EXIT_SUCCESS;
+      }
+   #endif
+   expect('D');
+   input_init();
+   if (auth) {
+      if (auth == 'a') {
+         crypt_seal(state, rounds, pos);
+      } else {
+         crypt_open(state, rounds, pos);
       }
+   } else if (threads > 1 || depth) {
+      #ifdef HAVE_PTHREAD_H
+         /* Two slices per worker let reading ahead and writing behind
+          * overlap with encryption. */
+         if (!depth) depth = 2 * threads + 2;
+         crypt_pipelined(state, rounds, pos, threads, depth);
+      #endif
+   } else {
+      crypt_serial(state, rounds, pos);
    }
+   output_finish();
    if (fflush(0)) write_error();
    release_resources();
 }
@@ -0,0 +1,83 @@
+#! /bin/sh
+# Known-answer tests run by "make check". Checks the ChaCha20, ChaCha12 and
+# ChaCha8 test vectors from ChaCha20.adoc. Also checks that a keystream
+# block does not depend on which of the SIMD kernels has computed it.
+#
+# Version 2026.290
+#
+# Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+#
+# This script is free software.
+# Distribution is permitted under the terms of the GPLv3.
+
+set -e
+LC_ALL=C; export LC_ALL
+trap 'test $? = 0 || echo "\"$0\" failed!" >& 2' 0
+failed=0
+
+# The key 00 01 02 ... 1f of the test vectors.
+key() {
+	awk 'BEGIN {for (i= 0; i < 32; ++i) printf "%c", i}'
+}
+
+# keystream <rounds> <skip> <blocks>
+#
+# Encrypt <blocks> zero blocks starting at the test vector's block 1 plus
+# <skip>, using <rounds> rounds. Prints the last block as hex octets.
+keystream() {
+	pos=`expr $2 + 1`; pos=`printf %03o $pos`
+	{
+		printf R; printf "\\`printf %03o $1`"
+		printf "P\\011\\0\\0\\0\\0\\0\\0\\$pos"
+		printf K; key; printf 'N\0\0\0\112\0\0\0\0D'
+		dd if=/dev/zero bs=64 count=$3 2> /dev/null
+	} | ./chacha20 | tail -c 64 | od -An -tx1 | tr -s ' \n' '  ' \
+	| sed 's/^ //; s/ $//'
+}
+
+# verdict <description> <expected> <actual>
+verdict() {
+	if test "$2" = "$3"
+	then
+		echo "PASS: $1"
+	else
+		echo "FAIL: $1"
+		echo "      expected: $2"
+		echo "      actual:   $3"
+		failed=1
+	fi
+}
+
+verdict ChaCha20 "`echo \
+	10 f1 e7 e4 d1 3b 59 15 50 0f dd 1f a3 20 71 c4 \
+	c7 d1 f4 c7 33 c0 68 03 04 22 aa 9a c3 d4 6c 4e \
+	d2 82 64 46 07 9f aa 09 14 c2 d7 05 d9 8b 02 a2 \
+	b5 12 9c d1 de 16 4e b9 cb d0 83 e8 a2 50 3c 4e`" \
+	"`keystream 20 0 1`"
+verdict ChaCha12 "`echo \
+	7f 8b 13 66 77 c7 37 99 e3 e7 77 7d 16 e6 d8 cc \
+	c7 87 ce 39 69 49 90 c6 28 e0 87 02 9c e9 19 0b \
+	da 4b e3 1a c3 fe 21 02 a9 ad 73 7c f8 2f a3 b0 \
+	6e 68 b6 33 71 c6 5c 82 72 99 04 0a de 1b a8 a0`" \
+	"`keystream 12 0 1`"
+verdict ChaCha8 "`echo \
+	ee ad 9d fb bc 60 44 3e 9d 68 11 ba b8 e6 0a 3a \
+	c6 00 1e 0d fb 98 5f 65 ef cb 0e a4 24 54 41 1c \
+	64 74 7e f7 3d 47 66 e0 c2 0e 19 20 8e 5c b1 17 \
+	77 d4 87 26 31 52 e6 5d c5 ff 94 7f ca b2 3b 2b`" \
+	"`keystream 8 0 1`"
+
+# Runs of 31 and 32 blocks end with blocks computed by differently wide
+# kernels, depending on the CPU. A single block is always computed by the
+# scalar code.
+for rounds in 20 12 8
+do
+	for blocks in 31 32
+	do
+		skip=`expr $blocks - 1`
+		verdict "ChaCha$rounds block $blocks of $blocks" \
+			"`keystream $rounds $skip 1`" "`keystream $rounds 0 $blocks`"
+	done
+done
+
+test $failed = 0
@@ -0,0 +1,172 @@
+/*
+ * Poly1305 one-time authenticator, using 5 limbs of 26 bits each so that
+ * all products fit into 64 bits.
+ *
+ * Version 2026.290
+ *
+ * Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+ *
+ * This source file is free software.
+ * Distribution is permitted under the terms of the GPLv3.
+ */
+
+#ifdef HAVE_CONFIG_H
+   #include "config.h"
+#endif
+#include "poly1305.h"
+#include <string.h>
+
+/* Deserialize a little-endian 32-bit word. */
+static uint32_t le32(unsigned char const *p) {
+   return
+      (uint32_t)p[0] | (uint32_t)p[1] << 8
+      | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24
+   ;
+}
+
+static void put_le32(unsigned char *p, uint32_t w) {
+   p[0] = (unsigned char)w; p[1] = (unsigned char)(w >> 8);
+   p[2] = (unsigned char)(w >> 16); p[3] = (unsigned char)(w >> 24);
+}
+
+void poly1305_init(struct poly1305 *ctx, unsigned char const *key) {
+   unsigned i;
+   /* Clamp r. */
+   ctx->r[0] = le32(key) & 0x3ffffff;
+   ctx->r[1] = le32(key + 3) >> 2 & 0x3ffff03;
+   ctx->r[2] = le32(key + 6) >> 4 & 0x3ffc0ff;
+   ctx->r[3] = le32(key + 9) >> 6 & 0x3f03fff;
+   ctx->r[4] = le32(key + 12) >> 8 & 0x00fffff;
+   for (i = 0; i < 4; ++i) ctx->s[i] = le32(key + 16 + 4 * i);
+   for (i = 5; i--; ) ctx->h[i] = 0;
+   ctx->buffered = 0;
+}
+
+/* Process <blocks> 16-octet blocks. <hibit> is 1 << 24 for complete blocks
+ * and 0 for the padded final block. */
+static void poly1305_blocks(
+   struct poly1305 *ctx, unsigned char const *m, size_t blocks,
+   uint32_t hibit
+) {
+   uint32_t const r0 = ctx->r[0], r1 = ctx->r[1], r2 = ctx->r[2];
+   uint32_t const r3 = ctx->r[3], r4 = ctx->r[4];
+   uint32_t const s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+   uint32_t h0 = ctx->h[0], h1 = ctx->h[1], h2 = ctx->h[2];
+   uint32_t h3 = ctx->h[3], h4 = ctx->h[4];
+   for (; blocks--; m += 16) {
+      uint64_t d0, d1, d2, d3, d4;
+      uint32_t c;
+      /* h += m */
+      h0 += le32(m) & 0x3ffffff;
+      h1 += le32(m + 3) >> 2 & 0x3ffffff;
+      h2 += le32(m + 6) >> 4 & 0x3ffffff;
+      h3 += le32(m + 9) >> 6 & 0x3ffffff;
+      h4 += le32(m + 12) >> 8 | hibit;
+      /* h *= r, reducing modulo 2^130 - 5 on the fly. */
+      d0 =
+         (uint64_t)h0 * r0 + (uint64_t)h1 * s4 + (uint64_t)h2 * s3
+         + (uint64_t)h3 * s2 + (uint64_t)h4 * s1
+      ;
+      d1 =
+         (uint64_t)h0 * r1 + (uint64_t)h1 * r0 + (uint64_t)h2 * s4
+         + (uint64_t)h3 * s3 + (uint64_t)h4 * s2
+      ;
+      d2 =
+         (uint64_t)h0 * r2 + (uint64_t)h1 * r1 + (uint64_t)h2 * r0
+         + (uint64_t)h3 * s4 + (uint64_t)h4 * s3
+      ;
+      d3 =
+         (uint64_t)h0 * r3 + (uint64_t)h1 * r2 + (uint64_t)h2 * r1
+         + (uint64_t)h3 * r0 + (uint64_t)h4 * s4
+      ;
+      d4 =
+         (uint64_t)h0 * r4 + (uint64_t)h1 * r3 + (uint64_t)h2 * r2
+         + (uint64_t)h3 * r1 + (uint64_t)h4 * r0
+      ;
+      /* Partial carry propagation. */
+      c = (uint32_t)(d0 >> 26); h0 = (uint32_t)d0 & 0x3ffffff;
+      d1 += c; c = (uint32_t)(d1 >> 26); h1 = (uint32_t)d1 & 0x3ffffff;
+      d2 += c; c = (uint32_t)(d2 >> 26); h2 = (uint32_t)d2 & 0x3ffffff;
+      d3 += c; c = (uint32_t)(d3 >> 26); h3 = (uint32_t)d3 & 0x3ffffff;
+      d4 += c; c = (uint32_t)(d4 >> 26); h4 = (uint32_t)d4 & 0x3ffffff;
+      h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+      h1 += c;
+   }
+   ctx->h[0] = h0; ctx->h[1] = h1; ctx->h[2] = h2;
+   ctx->h[3] = h3; ctx->h[4] = h4;
+}
+
+void poly1305_update(struct poly1305 *ctx, void const *data, size_t bytes) {
+   unsigned char const *m = data;
+   if (ctx->buffered) {
+      size_t want = sizeof ctx->buf - ctx->buffered;
+      if (want > bytes) want = bytes;
+      (void)memcpy(ctx->buf + ctx->buffered, m, want);
+      m += want; bytes -= want;
+      if ((ctx->buffered += want) < sizeof ctx->buf) return;
+      poly1305_blocks(ctx, ctx->buf, 1, (uint32_t)1 << 24);
+      ctx->buffered = 0;
+   }
+   if (bytes >= 16) {
+      size_t blocks = bytes / 16;
+      poly1305_blocks(ctx, m, blocks, (uint32_t)1 << 24);
+      m += blocks * 16; bytes -= blocks * 16;
+   }
+   if (bytes) {
+      (void)memcpy(ctx->buf, m, bytes);
+      ctx->buffered = bytes;
+   }
+}
+
+void poly1305_finish(struct poly1305 *ctx, unsigned char *tag) {
+   uint32_t h0, h1, h2, h3, h4, g0, g1, g2, g3, g4, c, mask;
+   uint64_t f;
+   if (ctx->buffered) {
+      /* Pad the final block with a 1 octet followed by zeros. */
+      size_t i = ctx->buffered;
+      ctx->buf[i++] = 1;
+      while (i < sizeof ctx->buf) ctx->buf[i++] = 0;
+      poly1305_blocks(ctx, ctx->buf, 1, 0);
+   }
+   h0 = ctx->h[0]; h1 = ctx->h[1]; h2 = ctx->h[2];
+   h3 = ctx->h[3]; h4 = ctx->h[4];
+   /* Full carry propagation. */
+   c = h1 >> 26; h1 &= 0x3ffffff;
+   h2 += c; c = h2 >> 26; h2 &= 0x3ffffff;
+   h3 += c; c = h3 >> 26; h3 &= 0x3ffffff;
+   h4 += c; c = h4 >> 26; h4 &= 0x3ffffff;
+   h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+   h1 += c;
+   /* Compute g = h + 5 - 2^130 and select it if there was no borrow. */
+   g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+   g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+   g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+   g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+   g4 = h4 + c - ((uint32_t)1 << 26);
+   mask = (g4 >> 31) - 1;
+   h0 = h0 & ~mask | g0 & mask;
+   h1 = h1 & ~mask | g1 & mask;
+   h2 = h2 & ~mask | g2 & mask;
+   h3 = h3 & ~mask | g3 & mask;
+   h4 = h4 & ~mask | g4 & mask;
+   /* h = (h + s) % 2^128 */
+   h0 = h0 | h1 << 26;
+   h1 = h1 >> 6 | h2 << 20;
+   h2 = h2 >> 12 | h3 << 14;
+   h3 = h3 >> 18 | h4 << 8;
+   f = (uint64_t)h0 + ctx->s[0]; put_le32(tag, (uint32_t)f);
+   f = (uint64_t)h1 + ctx->s[1] + (f >> 32); put_le32(tag + 4, (uint32_t)f);
+   f = (uint64_t)h2 + ctx->s[2] + (f >> 32); put_le32(tag + 8, (uint32_t)f);
+   f = (uint64_t)h3 + ctx->s[3] + (f >> 32); put_le32(tag + 12, (uint32_t)f);
+   {
+      volatile unsigned char *p = (volatile unsigned char *)ctx;
+      size_t n = sizeof *ctx;
+      while (n--) *p++ = 0;
+   }
+}
+
+int poly1305_verify(unsigned char const *tag1, unsigned char const *tag2) {
+   unsigned diff = 0, i;
+   for (i = 0; i < POLY1305_TAG_SIZE; ++i) diff |= tag1[i] ^ tag2[i];
+   return !diff;
+}
@@ -0,0 +1,47 @@
+/*
+ * #include "poly1305.h"
+ *
+ * Poly1305 one-time authenticator as specified in RFC 8439. The state is
+ * updated incrementally, so the tag can be computed in the same pass as
+ * the encryption.
+ *
+ * Version 2026.290
+ *
+ * Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+ *
+ * This source file is free software.
+ * Distribution is permitted under the terms of the GPLv3.
+ */
+
+#ifndef HEADER_SUMCM4MORWCY79O3RK3DMS7D3_INCLUDED
+#define HEADER_SUMCM4MORWCY79O3RK3DMS7D3_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Octets of a Poly1305 key and of a tag, respectively. */
+#define POLY1305_KEY_SIZE 32
+#define POLY1305_TAG_SIZE 16
+
+/* Opaque state. Uses 26-bit limbs for the accumulator and for r. */
+struct poly1305 {
+   uint32_t r[5], h[5], s[4];
+   unsigned char buf[16];
+   size_t buffered;
+};
+
+/* Start a new authenticator using the one-time <key>. The key must never
+ * be used for more than a single message. */
+void poly1305_init(struct poly1305 *ctx, unsigned char const *key);
+
+/* Authenticate <bytes> more octets from <data>. */
+void poly1305_update(struct poly1305 *ctx, void const *data, size_t bytes);
+
+/* Write the tag for all octets authenticated so far to <tag> and wipe the
+ * state. */
+void poly1305_finish(struct poly1305 *ctx, unsigned char *tag);
+
+/* Compare two tags in constant time. Returns non-zero if they are equal. */
+int poly1305_verify(unsigned char const *tag1, unsigned char const *tag2);
+
+#endif /* !HEADER_SUMCM4MORWCY79O3RK3DMS7D3_INCLUDED */
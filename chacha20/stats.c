@@ -0,0 +1,134 @@
+/*
+ * Run-time statistics, see "stats.h".
+ *
+ * Version 2026.290
+ *
+ * Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+ *
+ * This source file is free software.
+ * Distribution is permitted under the terms of the GPLv3.
+ */
+
+#ifdef HAVE_CONFIG_H
+   #include "config.h"
+#endif
+#include "stats.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_PHASES 8
+
+/* The read and the write counters are kept apart, including the time
+ * spent, because they may be updated by different threads. */
+static struct {
+   char const *tool;
+   int enabled;
+   unsigned phases, current;
+   struct {
+      char const *name;
+      uint64_t wall, cpu;
+   } phase[MAX_PHASES];
+   uint64_t wall0, cpu0; /* Start of the current phase. */
+   struct stats_io {
+      uint64_t calls, bytes, wall, timed;
+   } in, out;
+} stats;
+
+static uint64_t now(clockid_t clock) {
+   struct timespec ts;
+   if (clock_gettime(clock, &ts)) return 0;
+   return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/* Add the time since the start of the current phase to it. */
+static void close_phase(void) {
+   uint64_t const wall = now(CLOCK_MONOTONIC);
+   uint64_t const cpu = now(CLOCK_PROCESS_CPUTIME_ID);
+   stats.phase[stats.current].wall += wall - stats.wall0;
+   stats.phase[stats.current].cpu += cpu - stats.cpu0;
+   stats.wall0 = wall; stats.cpu0 = cpu;
+}
+
+static void report(void) {
+   uint64_t wall = 0, cpu = 0, bytes;
+   unsigned i;
+   close_phase();
+   for (i = 0; i < stats.phases; ++i) {
+      wall += stats.phase[i].wall; cpu += stats.phase[i].cpu;
+   }
+   bytes = stats.in.bytes > stats.out.bytes ? stats.in.bytes : stats.out.bytes;
+   (void)fprintf(
+      stderr,
+      "simpenc-stats tool=%s wall_s=%.6f cpu_s=%.6f bytes_in=%" PRIu64
+      " bytes_out=%" PRIu64 " reads=%" PRIu64 " writes=%" PRIu64,
+      stats.tool, wall / 1e9, cpu / 1e9,
+      stats.in.bytes, stats.out.bytes, stats.in.calls, stats.out.calls
+   );
+   if (stats.in.timed || stats.out.timed) {
+      (void)fprintf(
+         stderr, " io_wall_s=%.6f", (stats.in.wall + stats.out.wall) / 1e9
+      );
+   }
+   (void)fprintf(stderr, " mb_s=%.3f", wall ? bytes * 1e3 / wall : 0.0);
+   for (i = 0; i < stats.phases; ++i) {
+      (void)fprintf(
+         stderr, " %s_wall_s=%.6f %s_cpu_s=%.6f",
+         stats.phase[i].name, stats.phase[i].wall / 1e9,
+         stats.phase[i].name, stats.phase[i].cpu / 1e9
+      );
+   }
+   (void)fputc('\n', stderr);
+}
+
+void stats_init(char const *tool) {
+   char const *env = getenv("SIMPENC_STATS");
+   stats.tool = tool;
+   stats.phase[0].name = "setup"; stats.phases = 1; stats.current = 0;
+   stats.wall0 = now(CLOCK_MONOTONIC);
+   stats.cpu0 = now(CLOCK_PROCESS_CPUTIME_ID);
+   if (env && *env && strcmp(env, "0")) stats_enable();
+}
+
+void stats_enable(void) {
+   if (!stats.enabled) stats.enabled = !atexit(report);
+}
+
+void stats_phase(char const *name) {
+   unsigned i;
+   if (!stats.enabled) return;
+   close_phase();
+   for (i = 0; i < stats.phases; ++i) {
+      if (!strcmp(stats.phase[i].name, name)) {
+         stats.current = i;
+         return;
+      }
+   }
+   /* Keep adding to the current phase if there is no more room. */
+   if (stats.phases == MAX_PHASES) return;
+   stats.phase[i].name = name;
+   stats.phase[i].wall = stats.phase[i].cpu = 0;
+   stats.current = stats.phases++;
+}
+
+uint64_t stats_io_begin(void) {
+   return stats.enabled ? now(CLOCK_MONOTONIC) : 0;
+}
+
+static void account(struct stats_io *io, size_t bytes, uint64_t t0) {
+   ++io->calls; io->bytes += bytes;
+   if (t0) {
+      io->wall += now(CLOCK_MONOTONIC) - t0;
+      ++io->timed;
+   }
+}
+
+void stats_read(size_t bytes, uint64_t t0) {
+   account(&stats.in, bytes, t0);
+}
+
+void stats_write(size_t bytes, uint64_t t0) {
+   account(&stats.out, bytes, t0);
+}
@@ -0,0 +1,58 @@
+/*
+ * #include "stats.h"
+ *
+ * Run-time statistics. Enabled by setting the environment variable
+ * SIMPENC_STATS to anything but an empty string or "0", or by calling
+ * stats_enable(). When enabled, a single line is written to standard error
+ * when the program exits:
+ *
+ * simpenc-stats tool=<name> wall_s=<seconds> cpu_s=<seconds>
+ * bytes_in=<octets> bytes_out=<octets> reads=<calls> writes=<calls>
+ * [io_wall_s=<seconds>] mb_s=<MB/s> <phase>_wall_s=<seconds>
+ * <phase>_cpu_s=<seconds> ...
+ *
+ * all on the same line. This is the same format as that of the "wip"
+ * tools, so the results can be compared directly.
+ *
+ * The read counters and the write counters may be updated by two
+ * different threads, but each of them by only one thread at a time.
+ *
+ * Version 2026.290
+ *
+ * Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+ *
+ * This source file is free software.
+ * Distribution is permitted under the terms of the GPLv3.
+ */
+
+#ifndef HEADER_K3W9QF2ZR7TNB1XDM4VJ8HC5E_INCLUDED
+#define HEADER_K3W9QF2ZR7TNB1XDM4VJ8HC5E_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Start the "setup" phase. Call this first thing in main(). <tool> is the
+ * name to report. */
+void stats_init(char const *tool);
+
+/* Enable statistics regardless of the environment variable. */
+void stats_enable(void);
+
+/* End the current phase and start the phase <name>, which must be a string
+ * literal. Starting a phase again adds to its previous times. Must only be
+ * called by the main thread. */
+void stats_phase(char const *name);
+
+/* Returns the start time for stats_read() or stats_write(), or 0 if the
+ * duration of the I/O is not measured. */
+uint64_t stats_io_begin(void);
+
+/* Account for a read call which returned <bytes> octets and started at
+ * <t0> as returned by stats_io_begin(). Pass 0 as <t0> if the duration has
+ * not been measured. */
+void stats_read(size_t bytes, uint64_t t0);
+
+/* Like stats_read() for a write call of <bytes> octets. */
+void stats_write(size_t bytes, uint64_t t0);
+
+#endif /* !HEADER_K3W9QF2ZR7TNB1XDM4VJ8HC5E_INCLUDED */
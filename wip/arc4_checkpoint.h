@@ -0,0 +1,97 @@
+/*
+ * Checkpoints of an unfinished ARCFOUR key setup for shared use in
+ * different applications. Requires "arc4_common.h" and at least
+ * _POSIX_C_SOURCE 200112L for fseeko().
+ *
+ * The format is the S-box, then i and j, then the number of key octets
+ * absorbed so far as an 8-octet big-endian integer. Resuming from a
+ * checkpoint continues the key setup exactly where it has been saved. The
+ * functions take the state as its first ARC4_STATE_OCTETS in <state>,
+ * which is how the contexts of libsimpenc store it.
+ *
+ * Version 2026.290
+ *
+ * Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+ *
+ * This source file is free software.
+ * Distribution is permitted under the terms of the GPLv3.
+ */
+
+#include <dim_sdbrke8ae851uitgzm4nv3ea2.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#define ARC4_STATE_OCTETS (SBOX_SIZE + 2)
+#define ARC4_CHECKPOINT_OCTETS (ARC4_STATE_OCTETS + 8)
+
+/* Write a checkpoint of <state> after <absorbed> key octets to <fname>.
+ * Returns 0 on success. */
+static inline int arc4_checkpoint_save(
+   char const *fname, unsigned char const *state, uint64_t absorbed
+) {
+   unsigned char buf[ARC4_CHECKPOINT_OCTETS];
+   unsigned k;
+   FILE *fh;
+   for (k= ARC4_STATE_OCTETS; k--; ) buf[k]= state[k];
+   for (k= ARC4_CHECKPOINT_OCTETS; k-- > ARC4_STATE_OCTETS; absorbed>>= 8) {
+      buf[k]= (unsigned char)(absorbed & 0xff);
+   }
+   if (!(fh= fopen(fname, "wb"))) return -1;
+   if (fwrite(buf, sizeof *buf, DIM(buf), fh) != DIM(buf)) {
+      (void)fclose(fh);
+      return -1;
+   }
+   return fclose(fh) ? -1 : 0;
+}
+
+/* Restore <state> and the number of key octets absorbed into it from the
+ * checkpoint file <fname>. Returns 0 on success, -1 if the file could not
+ * be read and 1 if its contents are not a valid checkpoint. */
+static inline int arc4_checkpoint_load(
+   char const *fname, unsigned char *state, uint64_t *absorbed
+) {
+   unsigned char buf[ARC4_CHECKPOINT_OCTETS + 1], seen[SBOX_SIZE];
+   size_t got;
+   unsigned k;
+   FILE *fh;
+   if (!(fh= fopen(fname, "rb"))) return -1;
+   got= fread(buf, sizeof *buf, DIM(buf), fh);
+   if (ferror(fh)) { (void)fclose(fh); return -1; }
+   if (fclose(fh)) return -1;
+   if (got != ARC4_CHECKPOINT_OCTETS) return 1;
+   /* The S-box must be a permutation. */
+   for (k= SBOX_SIZE; k--; ) seen[k]= 0;
+   for (k= SBOX_SIZE; k--; ) if (seen[buf[k]]++) return 1;
+   for (k= ARC4_STATE_OCTETS; k--; ) state[k]= buf[k];
+   for (*absorbed= 0, k= ARC4_STATE_OCTETS; k < ARC4_CHECKPOINT_OCTETS; ++k) {
+      *absorbed= *absorbed << 8 | buf[k];
+   }
+   return 0;
+}
+
+/* Skip the first <n> octets of <in>, which have already been absorbed into
+ * a checkpoint. A regular file is skipped by seeking past them, anything
+ * else such as a pipe by reading them. Returns 0 on success, -1 on a read
+ * error and 1 if <in> is shorter than that. */
+static inline int arc4_checkpoint_skip(FILE *in, uint64_t n) {
+   unsigned char buf[BUFSIZ];
+   struct stat st;
+   off_t pos;
+   if (
+      !fstat(fileno(in), &st) && S_ISREG(st.st_mode)
+      && (pos= ftello(in)) >= 0
+   ) {
+      if (pos > st.st_size || n > (uint64_t)(st.st_size - pos)) return 1;
+      return fseeko(in, (off_t)n, SEEK_CUR) ? -1 : 0;
+   }
+   while (n) {
+      size_t got= fread(
+         buf, sizeof *buf, n < DIM(buf) ? (size_t)n : DIM(buf), in
+      );
+      if (!got) return ferror(in) ? -1 : 1;
+      n-= got;
+   }
+   return 0;
+}
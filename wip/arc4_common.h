@@ -1,10 +1,10 @@
 /*
  * C Macros implementing the basic ARCFOUR algorithm for shared use in
- * different applications.
+ * different applications, and a context-based API built on top of them.
  *
- * Version 2020.359
+ * Version 2026.290
  *
- * Copyright (c) 2020 Guenther Brunthaler. All rights reserved.
+ * Copyright (c) 2020-2026 Guenther Brunthaler. All rights reserved.
  *
  * This source file is free software.
  * Distribution is permitted under the terms of the GPLv3.
@@ -34,3 +34,257 @@
    r4.s[r4.i]= r4.v2= r4.s[r4.j]; r4.s[r4.j]= r4.v1
 #define ARCFOUR_STEP_6_PRNG() r4.s[SBOX_MOD(r4.v1 + r4.v2)]
 #define ARCFOUR_STEP_7_KEY r4.i= SBOX_MOD(r4.i + 1)
+
+/* Context-based API. Unlike the macros above, every function works on an
+ * explicit context and keeps the indices in local variables while it runs,
+ * which allows the compiler to hold them in registers. Several independent
+ * instances can therefore be used side by side without any "#define r4"
+ * tricks.
+ *
+ * Key setup is arc4_init(), any number of arc4_absorb() calls and finally
+ * arc4_end_key(). This is the modified key schedule which processes every
+ * key octet exactly once. */
+
+#include <stddef.h>
+
+#define ARC4_UNROLL 4
+
+struct arc4 {
+   unsigned char s[SBOX_SIZE];
+   unsigned char i, j;
+};
+
+/* Same as ARCFOUR_STEP_1_KEY followed by ARCFOUR_STEP_2. */
+static inline void arc4_init(struct arc4 *ctx) {
+   unsigned i;
+   for (i= SBOX_SIZE; i--; ) ctx->s[i]= (unsigned char)i;
+   ctx->i= ctx->j= 0;
+}
+
+/* Process <n> more key octets. Like the PRNG steps below, this fetches the
+ * next s[i] ahead of the swap. */
+static inline void arc4_absorb(
+   struct arc4 *ctx, void const *key, size_t n
+) {
+   unsigned char *s= ctx->s, i= ctx->i, j= ctx->j, t, u, v;
+   unsigned char const *k= key;
+   #define ARC4_ABSORB_1 \
+      j+= t + *k++; u= s[j]; v= s[(unsigned char)(i + 1)]; \
+      s[i]= u; s[j]= t; if (j == (unsigned char)(i + 1)) v= t; \
+      ++i; t= v
+   t= s[i];
+   for (; n >= ARC4_UNROLL; n-= ARC4_UNROLL) {
+      ARC4_ABSORB_1; ARC4_ABSORB_1; ARC4_ABSORB_1; ARC4_ABSORB_1;
+   }
+   while (n--) { ARC4_ABSORB_1; }
+   #undef ARC4_ABSORB_1
+   ctx->i= i; ctx->j= j;
+}
+
+/* Same as ARCFOUR_STEP_2: Finish key setup. */
+static inline void arc4_end_key(struct arc4 *ctx) {
+   ctx->i= ctx->j= 0;
+}
+
+/* One PRNG step; the output octet is s[t + u]. The next s[i] is fetched
+ * into <v> before the swap is stored, so that this load does not have to
+ * wait for the stores. The comparison fixes <v> up for the case where the
+ * swap has overwritten it. Needs "t= s[i + 1]" before the first step, and
+ * <emit> runs before <t> is advanced. */
+#define ARC4_PRNG_1(emit) \
+   ++i; j+= t; u= s[j]; v= s[(unsigned char)(i + 1)]; \
+   s[i]= u; s[j]= t; if (j == (unsigned char)(i + 1)) v= t; \
+   emit; t= v
+
+/* Discard the next <n> octets of pseudorandom output. */
+static inline void arc4_drop(struct arc4 *ctx, size_t n) {
+   unsigned char *s= ctx->s, i= ctx->i, j= ctx->j, t, u, v;
+   t= s[(unsigned char)(i + 1)];
+   for (; n >= ARC4_UNROLL; n-= ARC4_UNROLL) {
+      ARC4_PRNG_1((void)u); ARC4_PRNG_1((void)u);
+      ARC4_PRNG_1((void)u); ARC4_PRNG_1((void)u);
+   }
+   while (n--) { ARC4_PRNG_1((void)u); }
+   ctx->i= i; ctx->j= j;
+}
+
+/* Write the next <n> octets of pseudorandom output to <out>. */
+static inline void arc4_generate(
+   struct arc4 *ctx, unsigned char *out, size_t n
+) {
+   unsigned char *s= ctx->s, i= ctx->i, j= ctx->j, t, u, v;
+   #define ARC4_GENERATE_1 \
+      ARC4_PRNG_1(*out++= s[(unsigned char)(t + u)])
+   t= s[(unsigned char)(i + 1)];
+   for (; n >= ARC4_UNROLL; n-= ARC4_UNROLL) {
+      ARC4_GENERATE_1; ARC4_GENERATE_1; ARC4_GENERATE_1; ARC4_GENERATE_1;
+   }
+   while (n--) { ARC4_GENERATE_1; }
+   #undef ARC4_GENERATE_1
+   ctx->i= i; ctx->j= j;
+}
+
+/* XOR the next <n> octets of pseudorandom output into <buf>. */
+static inline void arc4_xor(struct arc4 *ctx, unsigned char *buf, size_t n) {
+   unsigned char *s= ctx->s, i= ctx->i, j= ctx->j, t, u, v;
+   #define ARC4_XOR_1 \
+      ARC4_PRNG_1(*buf++^= s[(unsigned char)(t + u)])
+   t= s[(unsigned char)(i + 1)];
+   for (; n >= ARC4_UNROLL; n-= ARC4_UNROLL) {
+      ARC4_XOR_1; ARC4_XOR_1; ARC4_XOR_1; ARC4_XOR_1;
+   }
+   while (n--) { ARC4_XOR_1; }
+   #undef ARC4_XOR_1
+   ctx->i= i; ctx->j= j;
+}
+
+#undef ARC4_PRNG_1
+
+/* The SUBTRACT-XOR-SUBTRACT combiner of rc4sxs-crypt and its MAC. The
+ * keystream <ks> provides R0, R1 and R2 for every octet, in this order:
+ *
+ * C = ((P - R2) ^ R1) - R0
+ * P = ((C + R0) ^ R1) + R2 */
+
+#include <assert.h>
+
+/* 256 bit MACs should be safe enough even against quantum computer attacks. */
+#define ARC4_MAC_OCTETS 32
+
+#define ADD_MOD256(v, inc) ((v)= (v) + (inc) & 256 - 1)
+#define SUB_MOD256(v, dec) ADD_MOD256(v, 256 - (dec))
+#define ASSERT_MOD256(c) assert((c) >= 0); assert((c) < 256)
+
+/* Combine <n> octets from <src> with the keystream <ks> into <dst>, which
+ * may be the same as <src>. */
+static inline void arc4_sxs_encrypt(
+   unsigned char *dst, unsigned char const *src, unsigned char const *ks
+   , size_t n
+) {
+   size_t i;
+   for (i= 0; i < n; ++i) {
+      int out= (int)(unsigned)src[i];
+      ASSERT_MOD256(out);
+      SUB_MOD256(out, ks[3 * i + 2]);
+      out^= ks[3 * i + 1];
+      SUB_MOD256(out, ks[3 * i]);
+      ASSERT_MOD256(out);
+      dst[i]= (unsigned char)(unsigned)out;
+   }
+}
+
+/* The inverse of arc4_sxs_encrypt(). */
+static inline void arc4_sxs_decrypt(
+   unsigned char *dst, unsigned char const *src, unsigned char const *ks
+   , size_t n
+) {
+   size_t i;
+   for (i= 0; i < n; ++i) {
+      int out= (int)(unsigned)src[i];
+      ASSERT_MOD256(out);
+      ADD_MOD256(out, ks[3 * i]);
+      out^= ks[3 * i + 1];
+      ADD_MOD256(out, ks[3 * i + 2]);
+      ASSERT_MOD256(out);
+      dst[i]= (unsigned char)(unsigned)out;
+   }
+}
+
+/* <ctx> has absorbed the MAC key followed by the message as its key.
+ * Finish the key setup and derive the ARC4_MAC_OCTETS octets of the MAC
+ * into <out>. */
+static inline void arc4_mac_final(struct arc4 *ctx, unsigned char *out) {
+   unsigned char g[3 * ARC4_MAC_OCTETS];
+   unsigned i;
+   arc4_end_key(ctx);
+   arc4_drop(ctx, DROP_N);
+   arc4_generate(ctx, g, sizeof g);
+   for (i= 0; i < ARC4_MAC_OCTETS; ++i) {
+      int r= g[3 * i] ^ g[3 * i + 1];
+      ADD_MOD256(r, g[3 * i + 2]);
+      out[i]= (unsigned char)(unsigned)r;
+   }
+}
+
+/* Multi-lane engine: Runs ARC4_LANES independent instances ctx[0] through
+ * ctx[ARC4_LANES - 1] in lockstep. A single instance is one long chain of
+ * dependent loads and stores, but the chains of different instances are
+ * independent, so the processor can overlap them. Four lanes are the most
+ * which still keep their indices and S-box pointers in the registers of
+ * x86-64.
+ *
+ * The functions take a separate octet count for every lane. Only the
+ * minimum of those counts is processed in lockstep; the remainders are
+ * processed one lane after another. */
+
+#define ARC4_LANES 4
+#define ARC4_LANES_EACH(M) M(0); M(1); M(2); M(3)
+
+#define ARC4_LANE_LOAD(k) \
+   unsigned char *s##k= ctx[k].s, i##k= ctx[k].i, j##k= ctx[k].j
+#define ARC4_LANE_SAVE(k) ctx[k].i= i##k; ctx[k].j= j##k
+#define ARC4_LANE_PRNG(k) \
+   ++i##k; j##k+= t= s##k[i##k]; s##k[i##k]= u= s##k[j##k]; s##k[j##k]= t
+
+static inline size_t arc4_lanes_min(size_t const *n) {
+   size_t m= n[0];
+   unsigned k;
+   for (k= ARC4_LANES; --k; ) if (n[k] < m) m= n[k];
+   return m;
+}
+
+/* Like arc4_absorb() for every lane. */
+static inline void arc4_absorb_lanes(
+   struct arc4 *ctx, unsigned char const *const *key, size_t const *n
+) {
+   size_t m= arc4_lanes_min(n), r;
+   unsigned k;
+   {
+      unsigned char t;
+      #define ARC4_LANE_KEY_PTR(k) unsigned char const *p##k= key[k]
+      #define ARC4_LANE_ABSORB(k) \
+         j##k+= (t= s##k[i##k]) + *p##k++; \
+         s##k[i##k]= s##k[j##k]; s##k[j##k]= t; ++i##k
+      ARC4_LANES_EACH(ARC4_LANE_LOAD);
+      ARC4_LANES_EACH(ARC4_LANE_KEY_PTR);
+      for (r= m; r--; ) { ARC4_LANES_EACH(ARC4_LANE_ABSORB); }
+      ARC4_LANES_EACH(ARC4_LANE_SAVE);
+      #undef ARC4_LANE_ABSORB
+      #undef ARC4_LANE_KEY_PTR
+   }
+   for (k= ARC4_LANES; k--; ) arc4_absorb(ctx + k, key[k] + m, n[k] - m);
+}
+
+/* Like arc4_drop() for every lane. */
+static inline void arc4_drop_lanes(struct arc4 *ctx, size_t n) {
+   unsigned char t, u;
+   ARC4_LANES_EACH(ARC4_LANE_LOAD);
+   while (n--) { ARC4_LANES_EACH(ARC4_LANE_PRNG); }
+   (void)u;
+   ARC4_LANES_EACH(ARC4_LANE_SAVE);
+}
+
+/* Like arc4_generate() for every lane. */
+static inline void arc4_generate_lanes(
+   struct arc4 *ctx, unsigned char *const *out, size_t const *n
+) {
+   size_t m= arc4_lanes_min(n), r;
+   unsigned k;
+   {
+      unsigned char t, u;
+      #define ARC4_LANE_OUT_PTR(k) unsigned char *o##k= out[k]
+      #define ARC4_LANE_GENERATE(k) \
+         ARC4_LANE_PRNG(k); *o##k++= s##k[(unsigned char)(t + u)]
+      ARC4_LANES_EACH(ARC4_LANE_LOAD);
+      ARC4_LANES_EACH(ARC4_LANE_OUT_PTR);
+      for (r= m; r--; ) { ARC4_LANES_EACH(ARC4_LANE_GENERATE); }
+      ARC4_LANES_EACH(ARC4_LANE_SAVE);
+      #undef ARC4_LANE_GENERATE
+      #undef ARC4_LANE_OUT_PTR
+   }
+   for (k= ARC4_LANES; k--; ) arc4_generate(ctx + k, out[k] + m, n[k] - m);
+}
+
+#undef ARC4_LANE_PRNG
+#undef ARC4_LANE_SAVE
+#undef ARC4_LANE_LOAD
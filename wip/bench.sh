@@ -0,0 +1,135 @@
+#! /bin/sh
+# Throughput benchmark for the programs built in the current directory. Run
+# by "make bench" or "make bench-baseline".
+#
+# Usage: bench.sh [ -u ] <mib> ...
+#
+# Every program processes <mib> MiB of input through a pipe for every <mib>
+# argument. Anything from 1 up to 4096 (4 GiB) is sensible. The throughput
+# in MB/s is compared against the file bench-baseline.txt. Option -u
+# replaces that file with the results for the last <mib> instead.
+#
+# The ciphers process every octet in the same way regardless of its value,
+# so zero octets are as good as any other input.
+#
+# The chacha20 utility of the sibling directory is included if it has been
+# built there, so that its results can be compared with those of the
+# programs here. Set CHACHA20 to the path name of a different executable.
+#
+# Version 2026.290
+#
+# Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+#
+# This script is free software.
+# Distribution is permitted under the terms of the GPLv3.
+
+set -e
+LC_ALL=C; export LC_ALL
+BASELINE=bench-baseline.txt
+: ${CHACHA20:=../chacha20/chacha20}
+
+update=false
+while getopts u opt
+do
+	case $opt in
+		u) update=true;;
+		*) false || exit
+	esac
+done
+shift `expr $OPTIND - 1 || :`
+test $# != 0 || set 1 64
+
+T=`mktemp -d "${TMPDIR:-/tmp}/bench.XXXXXXXXXX"`
+trap 'rc=$?; rm -r -- "$T"; test $rc = 0 || echo "\"$0\" failed!" >& 2' 0
+
+# Milliseconds since the epoch, or at least whole seconds in milliseconds
+# if "date" does not support "%N".
+now() {
+	t=`date +%s%N`
+	case $t in
+		*[!0-9]*) expr `date +%s` \* 1000;;
+		*) expr "$t" : '\(.*\)......'
+	esac
+}
+
+zeros() {
+	dd if=/dev/zero bs=1048576 count=$1 2> /dev/null
+}
+
+i=0
+while test $i -lt 211
+do
+	printf '\052'; i=`expr $i + 1`
+done > "$T"/key
+
+# Run <name> with <mib> MiB of input. The remaining arguments are a command
+# which expects the number of MiB as its last argument.
+bench() {
+	name=$1 mib=$2; shift 2
+	start=`now`
+	"$@" $mib > /dev/null
+	stop=`now`
+	awk \
+		-v name=$name -v mib=$mib -v ms=`expr $stop - $start` \
+		-v baseline="`test ! -f $BASELINE || sed "/^$name /!d; s///" $BASELINE`" \
+		'BEGIN {
+			if (ms < 1) ms= 1
+			rate= mib * 1048576 / 1000 / ms
+			printf "%-16s %5u MiB %9.1f MB/s", name, mib, rate
+			if (baseline != "") {
+				printf "   baseline %9.1f MB/s (%+.0f%%)" \
+					, baseline, (rate / baseline - 1) * 100
+			}
+			printf "\n"
+			print name, rate > "/dev/stderr"
+		}' 2>> "$T"/rates
+}
+
+rc4_enc() { zeros $1 | ./rc4sxs-crypt -E "$T"/key; }
+rc4_dec() { zeros $1 | ./rc4sxs-crypt -D "$T"/key; }
+rc4_mac() { zeros $1 | ./rc4sxs-crypt -E "$T"/key -M "$T"/key; }
+rc4_mac_t() { zeros $1 | ./rc4sxs-crypt -E "$T"/key -M "$T"/key -T; }
+hash() { zeros $1 | ./treyfer-hash; }
+ofb() {
+	{
+		printf K; head -c 8 "$T"/key; printf S; head -c 256 /dev/zero
+		printf I; head -c 8 "$T"/key; printf T; zeros $1
+	} | ./treyfer-ofb 2> /dev/null
+}
+cfb() { { head -c 128 "$T"/key; zeros $1; } | ./treyfer-cfb-512; }
+cfb_dec() { { head -c 128 "$T"/key; zeros $1; } | ./treyfer-cfb-512 -d; }
+cfb_dec_j() {
+	{ head -c 128 "$T"/key; zeros $1; } | ./treyfer-cfb-512 -d -j 4
+}
+cc20_in() {
+	printf K; head -c 32 "$T"/key; printf N; head -c 8 "$T"/key
+	printf D; zeros $1
+}
+cc20() { cc20_in $1 | "$CHACHA20"; }
+cc20_j() { cc20_in $1 | "$CHACHA20" -j 4; }
+cc20_a() { cc20_in $1 | "$CHACHA20" -a; }
+
+for mib
+do
+	: > "$T"/rates
+	bench rc4sxs-E $mib rc4_enc
+	bench rc4sxs-D $mib rc4_dec
+	bench rc4sxs-E-M $mib rc4_mac
+	bench rc4sxs-E-M-T $mib rc4_mac_t
+	bench treyfer-hash $mib hash
+	bench treyfer-ofb $mib ofb
+	bench treyfer-cfb-512 $mib cfb
+	bench treyfer-cfb-D $mib cfb_dec
+	bench treyfer-cfb-D-j4 $mib cfb_dec_j
+	if test -x "$CHACHA20"
+	then
+		bench chacha20 $mib cc20
+		bench chacha20-j4 $mib cc20_j
+		bench chacha20-a $mib cc20_a
+	fi
+done
+if $update
+then
+	awk '{printf "%s %.1f\n", $1, $2}' "$T"/rates > $BASELINE
+	echo "Updated $BASELINE."
+fi
@@ -0,0 +1,219 @@
+#! /bin/sh
+# Known-answer tests for the programs built in the current directory. Run
+# by "make check", which also builds the test vector variant rc4sxs-crypt-tv.
+#
+# The inputs are generated here, so the expected results can be stated as
+# "cksum" output. Update them only after having made sure that a change of
+# the output is intentional.
+#
+# Version 2026.290
+#
+# Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+#
+# This script is free software.
+# Distribution is permitted under the terms of the GPLv3.
+
+set -e
+LC_ALL=C; export LC_ALL
+
+T=`mktemp -d "${TMPDIR:-/tmp}/check.XXXXXXXXXX"`
+trap 'rc=$?; rm -r -- "$T"; test $rc = 0 || echo "\"$0\" failed!" >& 2' 0
+failed=0
+
+# Print <n> lines of text.
+text() {
+	awk -v n="$1" 'BEGIN {
+		for (i= 0; i < n; ++i) print "Line " i " of the known-answer input."
+	}'
+}
+
+# Print <n> octets of text.
+octets() {
+	text "$1" | awk -v n="$1" '{
+		out= out $0 "\n"
+		if (length(out) >= n) { printf "%s", substr(out, 1, n); exit }
+	}'
+}
+
+# verdict <description> <expected> <actual>
+verdict() {
+	if test "$2" = "$3"
+	then
+		echo "PASS: $1"
+	else
+		echo "FAIL: $1"
+		echo "      expected: $2"
+		echo "      actual:   $3"
+		failed=1
+	fi
+}
+
+vectors=arcfour_test_vectors
+for k in $vectors/k?
+do
+	n=${k#$vectors/k}
+	if ./rc4sxs-crypt-tv -D $k < $vectors/i$n > "$T"/o \
+		&& cmp -s "$T"/o $vectors/o$n
+	then
+		verdict "ARCFOUR test vector $n" ok ok
+	else
+		verdict "ARCFOUR test vector $n" ok mismatch
+	fi
+done
+
+octets 211 > "$T"/key
+text 3 > "$T"/mkey
+text 500 > "$T"/plain
+verdict "rc4sxs-crypt -E" "2825731583 17890" \
+	"`./rc4sxs-crypt -E "$T"/key < "$T"/plain | cksum`"
+./rc4sxs-crypt -E "$T"/key -M "$T"/mkey < "$T"/plain > "$T"/cipher
+verdict "rc4sxs-crypt -E -M" "1922079114 17922" "`cksum < "$T"/cipher`"
+verdict "rc4sxs-crypt -D -M" "`cksum < "$T"/plain`" \
+	"`./rc4sxs-crypt -D "$T"/key -M "$T"/mkey < "$T"/cipher | cksum`"
+# Enough data to wrap around the ring of the MAC thread several times.
+text 40000 > "$T"/long
+./rc4sxs-crypt -E "$T"/key -M "$T"/mkey < "$T"/long > "$T"/lcipher
+verdict "rc4sxs-crypt -E -M -T" "`cksum < "$T"/lcipher`" \
+	"`./rc4sxs-crypt -E "$T"/key -M "$T"/mkey -T < "$T"/long | cksum`"
+verdict "rc4sxs-crypt -D -M -T" "`cksum < "$T"/long`" \
+	"`./rc4sxs-crypt -D "$T"/key -M "$T"/mkey -T < "$T"/lcipher | cksum`"
+verdict "rc4sxs-crypt -D -M -T from a pipe" "`cksum < "$T"/long`" \
+	"`cat "$T"/lcipher | ./rc4sxs-crypt -D "$T"/key -M "$T"/mkey -T \
+	| cksum`"
+verdict "rc4sxs-crypt hashing" "1355912919 32" \
+	"`octets 32 | ./rc4sxs-crypt -D "$T"/plain | cksum`"
+
+verdict "treyfer-hash of nothing" \
+	"CX2FJA7NHG6VXKL99XQLPVPQGCMFAEBE9G5W724RB7D3MYAE2GSR" \
+	"`printf '' | ./treyfer-hash`"
+verdict "treyfer-hash -x" \
+	"FC058D74521D30F0F91A5DBCB8A3673D7EE633ED481F234EBCFF1344E3D32F2F" \
+	"`printf abc | ./treyfer-hash -x`"
+verdict "treyfer-hash -r -B 1000" "278358077 1000" \
+	"`text 2000 | ./treyfer-hash -r -B 1000 | cksum`"
+verdict "treyfer-hash -t of nothing" \
+	"ZA7FHNNAKZMKS7C9G66MFYHX93PB4Q4BNR6HDWZLK6ACLZQ6MH2T" \
+	"`printf '' | ./treyfer-hash -t`"
+verdict "treyfer-hash -t -r -B 1000" "740379334 1000" \
+	"`text 2000 | ./treyfer-hash -t -r -B 1000 | cksum`"
+for n in 1 2 3 4 5 6 7 8
+do
+	text `expr $n \* 300` > "$T"/f$n
+done
+./treyfer-hash "$T"/f? > "$T"/serial
+verdict "treyfer-hash -j 3" "`cat "$T"/serial`" \
+	"`./treyfer-hash -j 3 "$T"/f?`"
+verdict "treyfer-hash -0 -j 3" "`cat "$T"/serial`" \
+	"`for f in "$T"/f?; do printf '%s\000' "$f"; done \
+	| ./treyfer-hash -0 -j 3`"
+verdict "treyfer-hash -C -j 3 -K" 8 \
+	"`./treyfer-hash -C "$T"/serial -j 3 -K "$T"/cache | grep -c ': OK$'`"
+echo >> "$T"/f8
+verdict "treyfer-hash -C -K after a change" "$T/f8: FAILED" \
+	"`./treyfer-hash -C "$T"/serial -K "$T"/cache 2> /dev/null \
+	| grep -v ': OK$'`"
+text 100000 > "$T"/leaves
+verdict "treyfer-hash -T" \
+	"tree:2TLCB6YZVE48G6YRKYNP9GEHPF4NDY2J9PFT2VDZ63FX3KGCNAFH" \
+	"`./treyfer-hash -T < "$T"/leaves`"
+verdict "treyfer-hash -T -j 3" \
+	"tree:2TLCB6YZVE48G6YRKYNP9GEHPF4NDY2J9PFT2VDZ63FX3KGCNAFH" \
+	"`./treyfer-hash -T -j 3 < "$T"/leaves`"
+# A checkpoint of the first 500 lines, skipped by seeking or by reading.
+text 500 | ./treyfer-hash -S "$T"/ckpt > /dev/null
+text 1000 > "$T"/log
+./treyfer-hash < "$T"/log > "$T"/digest
+verdict "treyfer-hash -R" "`cat "$T"/digest`" \
+	"`./treyfer-hash -R "$T"/ckpt < "$T"/log`"
+verdict "treyfer-hash -R from a pipe" "`cat "$T"/digest`" \
+	"`cat "$T"/log | ./treyfer-hash -R "$T"/ckpt`"
+
+{
+	printf K; octets 8; printf S; octets 256; printf I; octets 8; printf T
+	text 500
+} > "$T"/ofb
+# treyfer-ofb dumps its S-box to standard error.
+verdict "treyfer-ofb" "4235525017 17890" \
+	"`./treyfer-ofb < "$T"/ofb 2> /dev/null | cksum`"
+
+{ octets 128; text 500; } > "$T"/cfb
+verdict "treyfer-cfb-512" "2930280025 17890" \
+	"`./treyfer-cfb-512 < "$T"/cfb | cksum`"
+# More than a piece of -j and several segments of 64 KiB.
+{ octets 128; text 40000; } > "$T"/cfb
+{ octets 128; ./treyfer-cfb-512 < "$T"/cfb; } > "$T"/cipher
+verdict "treyfer-cfb-512 -d" "`text 40000 | cksum`" \
+	"`./treyfer-cfb-512 -d < "$T"/cipher | cksum`"
+verdict "treyfer-cfb-512 -d -j 3" "`text 40000 | cksum`" \
+	"`./treyfer-cfb-512 -d -j 3 < "$T"/cipher | cksum`"
+
+# Three jobs of different lengths, so that some lanes have to shadow others.
+: > "$T"/jobs
+for n in 1 2 3
+do
+	octets `expr $n \* 101` > "$T"/bkey$n
+	text `expr $n \* 700` > "$T"/bin$n
+	printf '%s\n' "$T"/bkey$n "$T"/bin$n "$T"/bout$n >> "$T"/jobs
+done
+./rc4sxs-crypt -B -E "$T"/jobs
+for n in 1 2 3
+do
+	verdict "rc4sxs-crypt -B -E job $n" \
+		"`./rc4sxs-crypt -E "$T"/bkey$n < "$T"/bin$n | cksum`" \
+		"`cksum < "$T"/bout$n`"
+done
+
+# libsimpenc, with all data passed in odd-sized pieces by simpenc-split,
+# must produce the same output as the tools.
+
+# lib <description> <input> <tool command> <simpenc-split arguments>: The
+# commands are evaluated by the shell.
+lib() {
+	verdict "libsimpenc $1" "`eval "$3" < "$2" | cksum`" \
+		"`eval "./simpenc-split $4" < "$2" | cksum`"
+}
+
+./rc4sxs-crypt -E "$T"/key -M "$T"/mkey < "$T"/plain > "$T"/rcipher
+lib rc4sxs-encrypt "$T"/plain './rc4sxs-crypt -E "$T"/key' \
+	'rc4sxs-encrypt "$T"/key'
+lib "rc4sxs-encrypt with MAC" "$T"/plain \
+	'./rc4sxs-crypt -E "$T"/key -M "$T"/mkey' \
+	'rc4sxs-encrypt "$T"/key "$T"/mkey'
+lib "rc4sxs-decrypt with MAC" "$T"/rcipher \
+	'./rc4sxs-crypt -D "$T"/key -M "$T"/mkey' \
+	'rc4sxs-decrypt "$T"/key "$T"/mkey'
+: > "$T"/empty
+for o in "" " -t" " -T" " -t -T"
+do
+	m=`echo "$o" | tr -d ' -'`
+	lib "treyfer-hash$o" "$T"/leaves "./treyfer-hash -r -B 1000$o" \
+		"treyfer-hash 1000 $m"
+	case $o in
+		*T) ;;
+		*) continue
+	esac
+	m=`echo "$m" | tr T L`
+	lib "treyfer-hash$o with separate leaves" "$T"/leaves \
+		"./treyfer-hash -r -B 1000$o" "treyfer-hash 1000 $m"
+	lib "treyfer-hash$o of nothing with separate leaves" "$T"/empty \
+		"./treyfer-hash -r -B 1000$o" "treyfer-hash 1000 $m"
+done
+lib treyfer-ofb "$T"/ofb './treyfer-ofb 2> /dev/null' treyfer-ofb
+lib treyfer-cfb-512 "$T"/cfb ./treyfer-cfb-512 treyfer-cfb-512-encrypt
+lib "treyfer-cfb-512 -d" "$T"/cipher './treyfer-cfb-512 -d' \
+	treyfer-cfb-512-decrypt
+# ChaCha12 from block 258 on. The expected result is that of the chacha20
+# tool, which is used instead if it has been built.
+{
+	printf 'R\014P\000\000\000\000\000\000\001\002K'; octets 32
+	printf N; octets 8; printf D; text 500
+} > "$T"/cc20
+if test -x ../chacha20/chacha20
+then
+	lib chacha20 "$T"/cc20 ../chacha20/chacha20 chacha20
+else
+	verdict "libsimpenc chacha20" "4056432378 17890" \
+		"`./simpenc-split chacha20 < "$T"/cc20 | cksum`"
+fi
+
+test $failed = 0
@@ -1,14 +1,38 @@
+kernel-bench.o: arc4_common.h
+kernel-bench.o: config.h
+kernel-bench.o: fragments/include/dim_sdbrke8ae851uitgzm4nv3ea2.h
+kernel-bench.o: fragments/include/getopt_nh7lll77vb62ycgwzwf30zlln.h
+kernel-bench.o: kernel-bench.c
+kernel-bench.o: treyfer_common.h
+kernel-bench.o: treyfer_sbox.h
+rc4sxs-crypt.o: arc4_checkpoint.h
 rc4sxs-crypt.o: arc4_common.h
 rc4sxs-crypt.o: config.h
 rc4sxs-crypt.o: fragments/include/dim_sdbrke8ae851uitgzm4nv3ea2.h
 rc4sxs-crypt.o: fragments/include/getopt_nh7lll77vb62ycgwzwf30zlln.h
 rc4sxs-crypt.o: rc4sxs-crypt.c
+rc4sxs-crypt.o: simpenc/include/simpenc_12xa3exh75vq0l98qouxald4m.h
+rc4sxs-crypt.o: stats_common.h
+simpenc-split.o: config.h
+simpenc-split.o: fragments/include/dim_sdbrke8ae851uitgzm4nv3ea2.h
+simpenc-split.o: fragments/include/getopt_nh7lll77vb62ycgwzwf30zlln.h
+simpenc-split.o: simpenc-split.c
+simpenc-split.o: simpenc/include/simpenc_12xa3exh75vq0l98qouxald4m.h
 treyfer-cfb-512.o: config.h
+treyfer-cfb-512.o: fragments/include/dim_sdbrke8ae851uitgzm4nv3ea2.h
+treyfer-cfb-512.o: fragments/include/getopt_nh7lll77vb62ycgwzwf30zlln.h
+treyfer-cfb-512.o: simpenc/include/simpenc_12xa3exh75vq0l98qouxald4m.h
+treyfer-cfb-512.o: stats_common.h
 treyfer-cfb-512.o: treyfer-cfb-512.c
-treyfer-cfb-512.o: treyfer_sbox.h
+treyfer-hash.o: arc4_checkpoint.h
 treyfer-hash.o: arc4_common.h
+treyfer-hash.o: config.h
 treyfer-hash.o: fragments/include/dim_sdbrke8ae851uitgzm4nv3ea2.h
 treyfer-hash.o: fragments/include/getopt_nh7lll77vb62ycgwzwf30zlln.h
+treyfer-hash.o: simpenc/include/simpenc_12xa3exh75vq0l98qouxald4m.h
+treyfer-hash.o: stats_common.h
 treyfer-hash.o: treyfer-hash.c
 treyfer-ofb.o: fragments/include/dim_sdbrke8ae851uitgzm4nv3ea2.h
+treyfer-ofb.o: simpenc/include/simpenc_12xa3exh75vq0l98qouxald4m.h
+treyfer-ofb.o: stats_common.h
 treyfer-ofb.o: treyfer-ofb.c
@@ -0,0 +1,381 @@
+#define VERSTR_1 "Version 2026.290"
+#define VERSTR_2 "Copyright (c) 2026 Guenther Brunthaler."
+
+static char help[]= { /* Formatted as 66 output columns. */
+   "kernel-bench - measure the primitive kernels in isolation\n"
+   "\n"
+   "Usage: kernel-bench [ <options> ] [ <kernel> ... ]\n"
+   "\n"
+   "The program calls the ARCFOUR and Treyfer kernels used by the\n"
+   "other programs of this project directly, without any I/O, and\n"
+   "reports how long a call takes. Unlike the throughput measured by\n"
+   "\"make bench\", this allows to attribute a regression to a\n"
+   "specific kernel.\n"
+   "\n"
+   "Every <kernel> argument selects all kernels whose names start\n"
+   "with it. All kernels are measured if there are no arguments.\n"
+   "\n"
+   "Every kernel is first called repeatedly for the warm-up time.\n"
+   "Then the number of calls per sample is doubled until a sample\n"
+   "takes at least the sample time, and the requested number of\n"
+   "samples is taken. The output has one line for each kernel:\n"
+   "\n"
+   "* The octets processed per call\n"
+   "\n"
+   "* The median of the nanoseconds per call\n"
+   "\n"
+   "* The 10th percentile, the median and the 90th percentile of the\n"
+   "cycles per octet\n"
+   "\n"
+   "* The throughput in MB/s, calculated from the median time\n"
+   "\n"
+   "Cycles are counted with perf_event_open() on Linux if the kernel\n"
+   "allows it. Otherwise the time stamp counter is read on x86, which\n"
+   "counts at a fixed reference frequency rather than the actual\n"
+   "clock frequency. Without either, the cycle columns show '-'. A\n"
+   "comment line at the beginning of the output tells which counter\n"
+   "has been used.\n"
+   "\n"
+   "The following <options> are supported:\n"
+   "\n"
+   "-n <samples>: Number of samples per kernel. Default: 31.\n"
+   "\n"
+   "-t <milliseconds>: Minimum duration of a sample. Default: 2.\n"
+   "\n"
+   "-w <milliseconds>: Warm-up time per kernel. Default: 100.\n"
+   "\n"
+   "-l: List the names of the kernels and exit.\n"
+   "\n"
+   "-h: Display this help and exit.\n"
+   "\n"
+   "-V: Display version information and exit.\n"
+};
+
+static char version_info[]= {
+   VERSTR_1 "\n"
+   "\n"
+   VERSTR_2 " All rights reserved.\n"
+   "\n"
+   "This program is free software.\n"
+   "Distribution is permitted under the terms of the GPLv3."
+};
+
+#ifdef __linux__
+   #define _DEFAULT_SOURCE /* For syscall(). */
+#endif
+#define _POSIX_C_SOURCE 200112L
+#include "config.h"
+#include <dim_sdbrke8ae851uitgzm4nv3ea2.h>
+#include <getopt_nh7lll77vb62ycgwzwf30zlln.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#ifdef __linux__
+   #include <unistd.h>
+   #include <sys/syscall.h>
+   #include <linux/perf_event.h>
+#endif
+#include "arc4_common.h"
+#include "treyfer_sbox.h"
+#include "treyfer_common.h"
+
+#if defined __GNUC__ && (defined __x86_64__ || defined __i386__)
+   #define HAVE_RDTSC
+#endif
+
+#define KEY_OCTETS 256
+#define STREAM_OCTETS 4096
+#define MAX_SAMPLES 1000
+
+static struct arc4 r4, lanes[ARC4_LANES];
+static unsigned char key[KEY_OCTETS], stream[STREAM_OCTETS];
+static unsigned char block[TREYFER_512_OCTETS], tkey[TREYFER_512_OCTETS];
+static unsigned char volatile sink;
+
+static void arc4_key_setup(void) {
+   arc4_init(&r4); arc4_absorb(&r4, key, sizeof key); arc4_end_key(&r4);
+}
+
+static void arc4_drop_n(void) {
+   arc4_drop(&r4, DROP_N);
+}
+
+static void arc4_generate_stream(void) {
+   arc4_generate(&r4, stream, sizeof stream);
+}
+
+static void arc4_xor_stream(void) {
+   arc4_xor(&r4, stream, sizeof stream);
+}
+
+static void arc4_generate_stream_lanes(void) {
+   unsigned char *out[ARC4_LANES];
+   size_t n[ARC4_LANES];
+   unsigned k;
+   for (k= ARC4_LANES; k--; ) {
+      out[k]= stream + k * (sizeof stream / ARC4_LANES);
+      n[k]= sizeof stream / ARC4_LANES;
+   }
+   arc4_generate_lanes(lanes, out, n);
+}
+
+static void treyfer_64(void) {
+   treyfer_encrypt_64(block, tkey, (unsigned char const *)sbox);
+}
+
+static void treyfer_512(void) {
+   treyfer_encrypt_512(block, tkey, (unsigned char const *)sbox);
+}
+
+static void treyfer_hash_compress(void) {
+   treyfer_compress(block, tkey, (unsigned char const *)sbox);
+}
+
+static struct kernel {
+   char const *name;
+   size_t octets; /* Processed per call. */
+   void (*call)(void);
+} const kernels[]= {
+      {"arc4-key-setup", KEY_OCTETS, arc4_key_setup}
+   ,  {"arc4-drop", DROP_N, arc4_drop_n}
+   ,  {"arc4-generate", STREAM_OCTETS, arc4_generate_stream}
+   ,  {"arc4-xor", STREAM_OCTETS, arc4_xor_stream}
+   ,  {"arc4-generate-lanes", STREAM_OCTETS, arc4_generate_stream_lanes}
+   ,  {"treyfer-64", TREYFER_64_OCTETS, treyfer_64}
+   ,  {"treyfer-512", TREYFER_512_OCTETS, treyfer_512}
+   ,  {"treyfer-compress", TREYFER_512_OCTETS, treyfer_hash_compress}
+};
+
+#ifdef __linux__
+   static int perf_fd= -1;
+#endif
+static char const *cycle_source= "none";
+
+/* Select the best available cycle counter. */
+static void cycles_init(void) {
+   #ifdef __linux__
+   {
+      struct perf_event_attr pe;
+      (void)memset(&pe, 0, sizeof pe);
+      pe.type= PERF_TYPE_HARDWARE; pe.size= sizeof pe;
+      pe.config= PERF_COUNT_HW_CPU_CYCLES;
+      pe.exclude_kernel= pe.exclude_hv= 1;
+      if (
+         (perf_fd= (int)syscall(SYS_perf_event_open, &pe, 0, -1, -1, 0))
+         >= 0
+      ) {
+         cycle_source= "perf_event_open (core cycles)";
+         return;
+      }
+   }
+   #endif
+   #ifdef HAVE_RDTSC
+      cycle_source= "rdtsc (reference cycles)";
+   #endif
+}
+
+/* Returns 0 if there is no cycle counter. */
+static int cycles_read(uint64_t *c) {
+   #ifdef __linux__
+      if (perf_fd >= 0) {
+         return read(perf_fd, c, sizeof *c) == (ssize_t)sizeof *c;
+      }
+   #endif
+   #ifdef HAVE_RDTSC
+      *c= __builtin_ia32_rdtsc();
+      return 1;
+   #else
+      (void)c;
+      return 0;
+   #endif
+}
+
+static uint64_t now_ns(void) {
+   struct timespec ts;
+   if (clock_gettime(CLOCK_MONOTONIC, &ts)) {
+      (void)fputs("clock_gettime() failed!\n", stderr);
+      exit(EXIT_FAILURE);
+   }
+   return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/* Call <k> <calls> times. Returns the elapsed nanoseconds and sets <*cyc>
+ * to the elapsed cycles, or to 0 if there is no cycle counter. */
+static uint64_t sample(
+   struct kernel const *k, unsigned long calls, uint64_t *cyc
+) {
+   uint64_t t0, t1, c0, c1;
+   int have_cycles;
+   unsigned long n;
+   t0= now_ns(); have_cycles= cycles_read(&c0);
+   for (n= calls; n--; ) k->call();
+   if (!have_cycles || !cycles_read(&c1)) c0= c1= 0;
+   t1= now_ns();
+   *cyc= c1 - c0;
+   return t1 - t0;
+}
+
+static int cmp_double(void const *a, void const *b) {
+   double const x= *(double const *)a, y= *(double const *)b;
+   return x < y ? -1 : x > y;
+}
+
+/* Nearest-rank percentile <p> of the sorted <v>[<n>]. */
+static double percentile(double const *v, unsigned n, unsigned p) {
+   return v[(n - 1) * p / 100];
+}
+
+/* Parse a positive number for option <opt>. Returns 0 if it is missing or
+ * invalid. */
+static unsigned long numeric_arg(
+   int *a, int *optpos, int argc, char **argv, int opt
+) {
+   char const *arg;
+   long v;
+   if (!(arg= getopt_simplest_mand_arg(a, optpos, argc, argv))) {
+      getopt_simplest_perror_missing_arg(opt); return 0;
+   }
+   if ((v= atol(arg)) < 1) {
+      (void)fprintf(stderr, "Invalid argument for option -%c!\n", opt);
+      return 0;
+   }
+   return (unsigned long)v;
+}
+
+int main(int argc, char **argv) {
+   char const *error= 0;
+   int a= 0;
+   unsigned long samples= 31, sample_ms= 2, warmup_ms= 100;
+   static double ns_per_call[MAX_SAMPLES], cyc_per_octet[MAX_SAMPLES];
+   {
+      int optpos= 0;
+      for (;;) {
+         int opt;
+         unsigned long *target;
+         switch (opt= getopt_simplest(&a, &optpos, argc, argv)) {
+            case 0: goto no_more_options;
+            case 'n': target= &samples; goto numeric;
+            case 't': target= &sample_ms; goto numeric;
+            case 'w':
+               target= &warmup_ms;
+               numeric:
+               if (!(*target= numeric_arg(&a, &optpos, argc, argv, opt))) {
+                  goto leave;
+               }
+               break;
+            case 'l':
+               {
+                  unsigned k;
+                  for (k= 0; k < DIM(kernels); ++k) {
+                     if (puts(kernels[k].name) < 0) goto wrerr;
+                  }
+               }
+               goto done;
+            case 'h': (void)fputs(help, stderr); /* Fall through. */
+            case 'V': error= version_info; goto fail;
+            default: getopt_simplest_perror_opt(opt); goto leave;
+         }
+      }
+   }
+   no_more_options:
+   if (samples > MAX_SAMPLES) {
+      error= "Too many samples requested!"; goto fail;
+   }
+   /* Arbitrary but fixed inputs. Any values work equally well. */
+   {
+      unsigned i;
+      for (i= DIM(key); i--; ) key[i]= (unsigned char)(i * 7 + 1);
+      for (i= DIM(tkey); i--; ) tkey[i]= (unsigned char)(i * 5 + 3);
+      arc4_key_setup();
+      for (i= ARC4_LANES; i--; ) {
+         lanes[i]= r4; arc4_drop(lanes + i, i + 1);
+      }
+   }
+   cycles_init();
+   if (
+      printf("# cycles: %s\n", cycle_source) < 0
+      || printf(
+         "# %-20s %8s %10s %9s %9s %9s %9s\n", "kernel", "octets"
+         , "ns/call", "cyc/B p10", "cyc/B med", "cyc/B p90", "MB/s"
+      ) < 0
+   ) {
+      goto wrerr;
+   }
+   {
+      unsigned k;
+      for (k= 0; k < DIM(kernels); ++k) {
+         struct kernel const *kp= kernels + k;
+         unsigned long calls;
+         uint64_t ns, cyc;
+         int have_cycles= 1;
+         unsigned s;
+         if (a < argc) {
+            int i;
+            for (i= a; i < argc; ++i) {
+               if (!strncmp(kp->name, argv[i], strlen(argv[i]))) break;
+            }
+            if (i == argc) continue;
+         }
+         /* Warm up. */
+         {
+            uint64_t const start= now_ns();
+            do kp->call(); while (now_ns() - start < warmup_ms * 1000000);
+         }
+         /* Calibrate the number of calls per sample. */
+         for (calls= 1; sample(kp, calls, &cyc) < sample_ms * 1000000; ) {
+            calls+= calls;
+         }
+         for (s= 0; s < samples; ++s) {
+            ns= sample(kp, calls, &cyc);
+            ns_per_call[s]= (double)ns / calls;
+            if (!cyc) have_cycles= 0;
+            cyc_per_octet[s]= (double)cyc / calls / kp->octets;
+         }
+         qsort(ns_per_call, samples, sizeof *ns_per_call, cmp_double);
+         qsort(cyc_per_octet, samples, sizeof *cyc_per_octet, cmp_double);
+         if (
+            printf(
+               "%-22s %8lu %10.1f", kp->name, (unsigned long)kp->octets
+               , percentile(ns_per_call, samples, 50)
+            ) < 0
+         ) {
+            goto wrerr;
+         }
+         if (have_cycles) {
+            if (
+               printf(
+                  " %9.2f %9.2f %9.2f"
+                  , percentile(cyc_per_octet, samples, 10)
+                  , percentile(cyc_per_octet, samples, 50)
+                  , percentile(cyc_per_octet, samples, 90)
+               ) < 0
+            ) {
+               goto wrerr;
+            }
+         } else {
+            if (printf(" %9s %9s %9s", "-", "-", "-") < 0) goto wrerr;
+         }
+         if (
+            printf(
+               " %9.1f\n"
+               , kp->octets * 1e3 / percentile(ns_per_call, samples, 50)
+            ) < 0
+         ) {
+            goto wrerr;
+         }
+      }
+   }
+   /* Make sure that no compiler can discard the work done. */
+   sink= stream[0] ^ block[0] ^ r4.s[0] ^ lanes[0].s[0];
+   done:
+   if (fflush(0)) {
+      wrerr: error= "Write error!";
+      fail:
+      (void)fputs(error, stderr);
+      (void)fputc('\n', stderr);
+   }
+   leave: return error ? EXIT_FAILURE : EXIT_SUCCESS;
+}
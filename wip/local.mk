@@ -1,4 +1,4 @@
-LOCALLY_GENERATED = $(DOCS) config.h
+LOCALLY_GENERATED = $(DOCS) config.h rc4sxs-crypt-tv
 
 DOCS = README.html
 
@@ -11,3 +11,26 @@ config.h:
 	case `uname -o` in \
 		*GNU*) echo '#define _FILE_OFFSET_BITS 64'; \
 	esac > $@
+
+# Sizes in MiB of the input processed by every program for "make bench".
+BENCH_MIB = 1 64
+
+.PHONY: check bench bench-baseline shared
+
+# Build libsimpenc also as a shared library.
+shared:
+	cd $(LIB_2_SUBDIR) && $(MAKE) shared
+
+check: $(TARGETS) rc4sxs-crypt-tv
+	sh check.sh
+
+bench: $(TARGETS)
+	sh bench.sh $(BENCH_MIB)
+
+bench-baseline: $(TARGETS)
+	sh bench.sh -u $(BENCH_MIB)
+
+# Variant of rc4sxs-crypt which processes the ARCFOUR test vectors.
+rc4sxs-crypt-tv: rc4sxs-crypt.c arc4_common.h config.h $(LIBS)
+	$(CC) $(AUG_CFLAGS) -D TESTVECTORS_PEMTFGYBNQJY1ZYR6J7I0HNUH \
+		$(LDFLAGS) -o $@ rc4sxs-crypt.c $(LIBS) $(LDLIBS)
@@ -17,7 +17,7 @@ scan:
 				tgt=$${src%.*}; \
 				echo "$$tgt: $$tgt.o "'$$(LIBS)'; \
 				echo "$$t"'$$(CC) $$(LDFLAGS) -o $$@' \
-					"$$tgt.o "'$$(LIBS)'; \
+					"$$tgt.o "'$$(LIBS) $$(LDLIBS)'; \
 			done 8>& 1 >& 9; \
 		} | sed "s/^/$$t/; "'s/$$/ \\/'; \
 		echo; \
@@ -1,5 +1,5 @@
-#define VERSTR_1 "Version 2021.326"
-#define VERSTR_2 "Copyright (c) 2020-2021 Guenther Brunthaler."
+#define VERSTR_1 "Version 2026.290"
+#define VERSTR_2 "Copyright (c) 2020-2026 Guenther Brunthaler."
 
 static char help[]= { /* Formatted as 66 output columns. */
    "rc4sxs-crypt - modified ARCFOUR using SUBTRACT-XOR-SUBTRACT\n"
@@ -35,6 +35,38 @@ static char help[]= { /* Formatted as 66 output columns. */
    "separate instance of the decryption algorithm, independent from\n"
    "the instance of the main operation mode (-D or -E).\n"
    "\n"
+   "-B: Batch mode for many short messages. The pathname argument of\n"
+   "-E or -D then refers to a job list rather than to a key. Every\n"
+   "job in the list consists of three lines: The pathname of the\n"
+   "one-time key, of the input file and of the output file. Up to 4\n"
+   "jobs are processed at the same time in an interleaved fashion,\n"
+   "which is considerably faster than running the program once for\n"
+   "every message. Cannot be combined with -M.\n"
+   "\n"
+   "-S <checkpoint>: Save the state of the key setup to the file\n"
+   "<checkpoint> after the whole key has been processed. This is\n"
+   "useful when hashing, where the data to be hashed is the key.\n"
+   "\n"
+   "-R <checkpoint>: Resume the key setup from a file written by -S.\n"
+   "The key file must start with the same octets as the key from\n"
+   "which the checkpoint has been saved. Those octets are skipped, by\n"
+   "seeking past them if the key file is a regular file, and only the\n"
+   "remaining octets of the key will be processed. This allows to\n"
+   "hash a growing log file without processing it again from the\n"
+   "beginning, or to re-use the state after a long common prefix such\n"
+   "as a MAC key or an account hash. Can be combined with -S for\n"
+   "updating the same checkpoint.\n"
+   "\n"
+   "-T: Calculate the MAC of option -M in a separate thread, running\n"
+   "in parallel with the encryption or decryption. The MAC will be\n"
+   "the same, but it will be available sooner on machines with more\n"
+   "than one CPU core.\n"
+   "\n"
+   "-v: Write statistics about the duration of the phases of the\n"
+   "program and about its I/O to standard error when it exits.\n"
+   "Setting the environment variable SIMPENC_STATS to anything but an\n"
+   "empty string or \"0\" does the same.\n"
+   "\n"
    "-h: Display this help and exit\n"
    "-V: Display version information and exit\n"
    "\n"
@@ -139,41 +171,336 @@ static char version_info[]= {
    "Distribution is permitted under the terms of the GPLv3."
 };
 
+#define _POSIX_C_SOURCE 200112L
 #include "config.h"
+#include <simpenc_12xa3exh75vq0l98qouxald4m.h>
 #include "arc4_common.h"
+#include "arc4_checkpoint.h"
+#include "stats_common.h"
 #include <dim_sdbrke8ae851uitgzm4nv3ea2.h>
 #include <getopt_nh7lll77vb62ycgwzwf30zlln.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
 
-/* 256 bit MACs should be safe enough even against quantum computer attacks. */
-#define MAC_OCTETS 32
+#define MAC_OCTETS SIMPENC_RC4SXS_MAC_OCTETS
+
+/* Number of blocks which can be queued for the MAC thread. */
+#define MAC_RING_SLOTS 16
+
+/* How often a thread yields to the other one while the ring is full or
+ * empty before going to sleep until the other thread wakes it up. */
+#define MAC_RING_SPINS 64
+
+static struct simpenc_rc4sxs r4;
+static struct simpenc_rc4sxs_mac mac;
+static int mac_threaded;
+static pthread_t mac_tid;
+
+/* Single-producer/single-consumer queue of ciphertext blocks for the MAC
+ * thread. <head> and <tail> are free-running counters; only the producer
+ * advances <head> and only the consumer advances <tail>. The ciphertext
+ * of a slot is at <data>, which is either the <block> of the slot or
+ * memory which stays unchanged until the MAC is complete. A block of
+ * length 0 tells the MAC thread to terminate. <sleeping> is set by the
+ * producer or the consumer while it waits on <wake>. */
+static struct {
+   unsigned char block[MAC_RING_SLOTS][BUFSIZ + MAC_OCTETS];
+   unsigned char const *data[MAC_RING_SLOTS];
+   size_t length[MAC_RING_SLOTS];
+   unsigned head, tail;
+   int sleeping[2];
+} ring;
+enum { PRODUCER, CONSUMER };
+
+static pthread_mutex_t ring_lock= PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ring_wake= PTHREAD_COND_INITIALIZER;
+
+/* Wait until the other thread has changed <*counter> from <stale>. <whom>
+ * is the waiting side. */
+static void ring_wait(unsigned *counter, unsigned stale, int whom) {
+   unsigned spins;
+   for (spins= MAC_RING_SPINS; spins--; (void)sched_yield()) {
+      if (__atomic_load_n(counter, __ATOMIC_ACQUIRE) != stale) return;
+   }
+   (void)pthread_mutex_lock(&ring_lock);
+   /* Paired with ring_advance(): Either the other thread sees <sleeping>
+    * set after storing the counter, or the check below sees the new
+    * value. */
+   __atomic_store_n(&ring.sleeping[whom], 1, __ATOMIC_SEQ_CST);
+   while (__atomic_load_n(counter, __ATOMIC_SEQ_CST) == stale) {
+      (void)pthread_cond_wait(&ring_wake, &ring_lock);
+   }
+   __atomic_store_n(&ring.sleeping[whom], 0, __ATOMIC_RELAXED);
+   (void)pthread_mutex_unlock(&ring_lock);
+}
+
+/* Set <*counter> to <value> and wake up <whom> if it is sleeping. */
+static void ring_advance(unsigned *counter, unsigned value, int whom) {
+   __atomic_store_n(counter, value, __ATOMIC_SEQ_CST);
+   if (__atomic_load_n(&ring.sleeping[whom], __ATOMIC_SEQ_CST)) {
+      (void)pthread_mutex_lock(&ring_lock);
+      (void)pthread_cond_signal(&ring_wake);
+      (void)pthread_mutex_unlock(&ring_lock);
+   }
+}
+
+static void *mac_thread(void *unused) {
+   unsigned tail= ring.tail;
+   size_t n;
+   (void)unused;
+   do {
+      unsigned slot= tail % MAC_RING_SLOTS;
+      ring_wait(&ring.head, tail, CONSUMER);
+      if (n= ring.length[slot]) {
+         simpenc_rc4sxs_mac_update(&mac, ring.data[slot], n);
+      }
+      ring_advance(&ring.tail, ++tail, PRODUCER);
+   } while (n);
+   return 0;
+}
+
+/* Wait until the next slot of the ring is free and return its block. The
+ * producer may fill it and pass it to mac_enqueue() without a copy. */
+static unsigned char *mac_slot(void) {
+   unsigned head= ring.head;
+   ring_wait(&ring.tail, head - MAC_RING_SLOTS, PRODUCER);
+   return ring.block[head % MAC_RING_SLOTS];
+}
+
+/* Queue <n> octets at <data> for the MAC thread in the slot returned by
+ * mac_slot(). <data> must be the block of that slot or stay unchanged
+ * until the MAC is complete. */
+static void mac_enqueue(unsigned char const *data, size_t n) {
+   unsigned head= ring.head, slot= head % MAC_RING_SLOTS;
+   ring.data[slot]= data; ring.length[slot]= n;
+   ring_advance(&ring.head, head + 1, CONSUMER);
+}
+
+/* Authenticate <n> more octets of ciphertext at <data>. Unless <stable>,
+ * the MAC thread (if any) gets a copy. Otherwise, <data> must be the
+ * block returned by mac_slot() or stay unchanged until the MAC is
+ * complete. */
+static void mac_absorb(unsigned char const *data, size_t n, int stable) {
+   if (!mac_threaded) {
+      simpenc_rc4sxs_mac_update(&mac, data, n);
+   } else if (n) {
+      unsigned char *block= mac_slot();
+      assert(n <= DIM(*ring.block) || stable);
+      if (!stable) (void)memcpy(block, data, n);
+      mac_enqueue(stable ? data : block, n);
+   }
+}
+
+/* Wait for the MAC thread (if any) to absorb the remaining ciphertext and
+ * derive the MAC from <mac> into <out>. */
+static int mac_digest(unsigned char *out) {
+   if (mac_threaded) {
+      (void)mac_slot(); mac_enqueue(0, 0);
+      if (pthread_join(mac_tid, 0)) return -1;
+      mac_threaded= 0;
+   }
+   simpenc_rc4sxs_mac_final(&mac, out);
+   return 0;
+}
+
+#ifdef TESTVECTORS_PEMTFGYBNQJY1ZYR6J7I0HNUH
+   /* The test vectors are for plain ARCFOUR without the drop, which
+    * libsimpenc does not provide. The key is set up in <r4> as usual, then
+    * copied here for generating the keystream. */
+   static struct arc4 tv;
+
+   static void tv_start(void) {
+      (void)memcpy(tv.s, r4.r4, SBOX_SIZE);
+      tv.i= r4.r4[SBOX_SIZE]; tv.j= r4.r4[SBOX_SIZE + 1];
+      arc4_end_key(&tv);
+   }
+#endif
+
+/* Encrypt <n> octets from <src> into <dst>, which may be the same. */
+static void encrypt_data(
+   unsigned char *dst, unsigned char const *src, size_t n
+) {
+   #ifdef TESTVECTORS_PEMTFGYBNQJY1ZYR6J7I0HNUH
+      static unsigned char ks[3 * BUFSIZ];
+      assert(n <= DIM(ks) / 3);
+      arc4_generate(&tv, ks, 3 * n);
+      arc4_sxs_encrypt(dst, src, ks, n);
+   #else
+      simpenc_rc4sxs_encrypt(&r4, dst, src, n);
+   #endif
+}
 
-#define ADD_MOD256(v, inc) ((v)= (v) + (inc) & 256 - 1)
-#define SUB_MOD256(v, dec) ADD_MOD256(v, 256 - (dec))
-#define ASSERT_MOD256(c) assert((c) >= 0); assert((c) < 256)
-#define CSPRNG_GET(out) \
-   ARCFOUR_STEP_3_PRNG; ARCFOUR_STEP_4_PRNG; ARCFOUR_STEP_5_PRNG; \
-   out= ARCFOUR_STEP_6_PRNG()
-#define DROP_INITIAL_KEYSTREAM() { \
-   unsigned drop; \
-   for (drop= DROP_N; drop--; ) { \
-      ARCFOUR_STEP_3_PRNG; ARCFOUR_STEP_4_PRNG; ARCFOUR_STEP_5_DROP; \
-   } \
+/* Decrypt <n> octets from <src> into <dst>, which may be the same. */
+static void decrypt(unsigned char *dst, unsigned char const *src, size_t n) {
+   #ifdef TESTVECTORS_PEMTFGYBNQJY1ZYR6J7I0HNUH
+      static unsigned char ks[BUFSIZ + MAC_OCTETS];
+      size_t i;
+      assert(n <= DIM(ks));
+      arc4_generate(&tv, ks, n);
+      for (i= 0; i < n; ++i) dst[i]= src[i] ^ ks[i];
+   #else
+      simpenc_rc4sxs_decrypt(&r4, dst, src, n);
+   #endif
+}
+
+#ifndef TESTVECTORS_PEMTFGYBNQJY1ZYR6J7I0HNUH
+/* Print a message about <pathname> and return the rest of it. */
+static char const *file_error(char const *what, char const *pathname) {
+   (void)fputs(what, stderr);
+   (void)fputs(" \"", stderr);
+   (void)fputs(pathname, stderr);
+   return "\"!";
+}
+
+/* Read the next line of <list> into <line> and strip the newline. Returns
+ * 0 at the end of the list. */
+static int get_line(char *line, FILE *list) {
+   size_t len;
+   if (!fgets(line, FILENAME_MAX, list)) return 0;
+   if ((len= strlen(line)) && line[len - 1] == '\n') line[--len]= '\0';
+   return 1;
+}
+
+/* Batch mode: Encrypt or decrypt every job in the list <jobs_fname>, where
+ * every job is a group of three lines: The pathnames of the one-time key,
+ * of the input and of the output. LANES jobs at a time are processed in
+ * lockstep by the multi-lane functions of libsimpenc. Lanes without a job
+ * of their own shadow lane 0, which keeps the lanes in lockstep until the
+ * last group. Returns 0 or an error message. */
+#define LANES SIMPENC_RC4SXS_LANES
+static char const *batch(char const *jobs_fname, int encrypt) {
+   static struct simpenc_rc4sxs ctx[LANES];
+   static char name[LANES][3][FILENAME_MAX];
+   static unsigned char buf[LANES][BUFSIZ];
+   FILE *jobs, *file[LANES][3];
+   void const *in[LANES];
+   void *out[LANES];
+   size_t n[LANES];
+   unsigned k, f, lanes;
+   enum { KEY, INPUT, OUTPUT };
+   if (!(jobs= fopen(jobs_fname, "r"))) {
+      return file_error("Could not open job list", jobs_fname);
+   }
+   do {
+      int more;
+      /* Collect the next group of jobs and open their files. */
+      for (lanes= 0; lanes < LANES; ++lanes) {
+         for (f= 0; f < 3; ++f) {
+            if (!get_line(name[lanes][f], jobs)) {
+               if (ferror(jobs)) {
+                  return file_error("Error reading job list", jobs_fname);
+               }
+               if (f) return "Incomplete job at end of job list!";
+               goto group_complete;
+            }
+            if (
+               !(
+                  file[lanes][f]= fopen(
+                     name[lanes][f], f == OUTPUT ? "wb" : "rb"
+                  )
+               )
+            ) {
+               return file_error("Could not open", name[lanes][f]);
+            }
+         }
+      }
+      group_complete:
+      if (!lanes) break;
+      /* Key setup. */
+      stats_phase("key_setup");
+      for (k= LANES; k--; ) simpenc_rc4sxs_init(&ctx[k]);
+      do {
+         more= 0;
+         for (k= 0; k < LANES; ++k) {
+            if (k < lanes) {
+               FILE *key= file[k][KEY];
+               if (
+                  (n[k]= fread(buf[k], sizeof **buf, BUFSIZ, key)) != BUFSIZ
+                  && ferror(key)
+               ) {
+                  return file_error("Error reading from", name[k][KEY]);
+               }
+               if (n[k]) more= 1;
+               in[k]= buf[k];
+            } else {
+               n[k]= n[0]; in[k]= in[0];
+            }
+         }
+         simpenc_rc4sxs_key_lanes(ctx, in, n);
+      } while (more);
+      stats_phase("drop");
+      simpenc_rc4sxs_start_lanes(ctx);
+      /* Encrypt or decrypt the data. */
+      stats_phase("bulk");
+      do {
+         more= 0;
+         for (k= 0; k < LANES; ++k) {
+            if (k < lanes) {
+               FILE *input= file[k][INPUT];
+               uint64_t t0= stats_io_begin();
+               if (
+                  (n[k]= fread(buf[k], sizeof **buf, BUFSIZ, input))
+                  != BUFSIZ && ferror(input)
+               ) {
+                  return file_error("Error reading from", name[k][INPUT]);
+               }
+               stats_read(n[k], t0);
+               if (n[k]) more= 1;
+            } else {
+               n[k]= n[0];
+            }
+            in[k]= out[k]= buf[k];
+         }
+         (
+            encrypt
+            ? simpenc_rc4sxs_encrypt_lanes : simpenc_rc4sxs_decrypt_lanes
+         )(ctx, out, in, n);
+         for (k= 0; k < lanes; ++k) {
+            uint64_t t0= stats_io_begin();
+            if (
+               fwrite(buf[k], sizeof **buf, n[k], file[k][OUTPUT]) != n[k]
+            ) {
+               return file_error("Error writing to", name[k][OUTPUT]);
+            }
+            stats_write(n[k], t0);
+         }
+      } while (more);
+      for (k= 0; k < lanes; ++k) {
+         for (f= 0; f < 3; ++f) {
+            if (fclose(file[k][f])) {
+               return file_error(
+                  f == OUTPUT ? "Error writing to" : "Error reading from"
+                  , name[k][f]
+               );
+            }
+         }
+      }
+   } while (lanes == LANES);
+   if (ferror(jobs) || fclose(jobs)) {
+      return file_error("Error reading job list", jobs_fname);
+   }
+   return 0;
 }
+#endif
 
 int main(int argc, char **argv) {
    char const *error= 0, *current_file, *enc_key_fname= 0, *mac_key_fname= 0;
-   int encrypt= -1;
+   char const *save_fname= 0, *resume_fname= 0;
+   int encrypt= -1, batch_mode= 0;
    FILE *key;
-   #define r4 mac
-      ARCFOUR_VARDEFS(static);
-   #undef r4
-   ARCFOUR_VARDEFS(static);
    static unsigned char iobuf[BUFSIZ + MAC_OCTETS];
    size_t prebuffered= 0;
+   int mapped= 0;
+   stats_init("rc4sxs-crypt");
    {
       int optpos= 0, optind= 0;
       for (;;) {
@@ -216,6 +543,24 @@ int main(int argc, char **argv) {
                   error= "Missing MAC key file pathname!"; goto fail;
                }
                break;
+            case 'S': case 'R':
+               {
+                  char const *arg;
+                  if (
+                     !(
+                        arg= getopt_simplest_mand_arg(
+                           &optind, &optpos, argc, argv
+                        )
+                     )
+                  ) {
+                     error= "Missing checkpoint file pathname!"; goto fail;
+                  }
+                  *(opt == 'S' ? &save_fname : &resume_fname)= arg;
+               }
+               break;
+            case 'T': mac_threaded= 1; break;
+            case 'B': batch_mode= 1; break;
+            case 'v': stats_enable(); break;
             case 'h':
                if (fputs(help, stdout) < 0) goto wrerr;
                /* Fall through. */
@@ -230,6 +575,24 @@ int main(int argc, char **argv) {
    if (encrypt < 0) {
       error= "Please specify -E or -D!"; goto fail;
    }
+   #ifdef TESTVECTORS_PEMTFGYBNQJY1ZYR6J7I0HNUH
+      if (save_fname || resume_fname) {
+         error= "-S and -R are not supported by this build!"; goto fail;
+      }
+   #endif
+   if (batch_mode) {
+      #ifdef TESTVECTORS_PEMTFGYBNQJY1ZYR6J7I0HNUH
+         error= "-B is not supported by this build!";
+      #else
+         if (mac_key_fname || save_fname || resume_fname) {
+            error= "-B cannot be combined with -M, -S or -R!";
+         } else if (!(error= batch(enc_key_fname, encrypt))) {
+            goto cleanup;
+         }
+      #endif
+      goto fail;
+   }
+   stats_phase("key_setup");
    if (!(key= fopen(current_file= enc_key_fname, "rb"))) {
       (void)fputs("Could not open key file", stderr);
       add_arg:
@@ -245,32 +608,62 @@ int main(int argc, char **argv) {
       goto fail;
    }
    {
+      size_t got;
+      uint64_t absorbed= 0;
       #ifdef TESTVECTORS_PEMTFGYBNQJY1ZYR6J7I0HNUH
-      static char recycle[SBOX_SIZE << 1];
-      int klen= 0;
+      /* Only the first SBOX_SIZE key octets count; shorter keys will be
+       * recycled. */
+      static unsigned char recycle[SBOX_SIZE];
+      size_t klen= 0;
       #endif
-      ARCFOUR_STEP_1_KEY; ARCFOUR_STEP_2;
-      {
-         int c;
-         while ((c= getc(key)) != EOF) {
-            ASSERT_MOD256(c);
-            #ifdef TESTVECTORS_PEMTFGYBNQJY1ZYR6J7I0HNUH
-            if (klen >= SBOX_SIZE) { assert(klen == SBOX_SIZE); break; }
-            if (klen < (int)DIM(recycle)) recycle[klen]= (char)c;
-            ++klen;
-            #endif
-            ARCFOUR_STEP_4_KEY((unsigned)c);
-            ARCFOUR_STEP_5_DROP; ARCFOUR_STEP_7_KEY;
+      if (resume_fname) {
+         switch (arc4_checkpoint_load(resume_fname, r4.r4, &absorbed)) {
+            case 0: break;
+            case 1:
+               (void)fputs("Invalid checkpoint file", stderr);
+               goto ckpt_arg;
+            default:
+               (void)fputs("Could not read checkpoint file", stderr);
+               ckpt_arg:
+               current_file= resume_fname;
+               goto add_arg;
+         }
+         switch (arc4_checkpoint_skip(key, absorbed)) {
+            case 0: break;
+            case 1:
+               (void)fputs(
+                  "Checkpoint covers more than the contents of key file"
+                  , stderr
+               );
+               goto add_arg;
+            default: goto krderr;
+         }
+      } else {
+         simpenc_rc4sxs_init(&r4);
+      }
+      while (got= fread(iobuf, sizeof *iobuf, BUFSIZ, key)) {
+         #ifdef TESTVECTORS_PEMTFGYBNQJY1ZYR6J7I0HNUH
+         if (got > DIM(recycle) - klen) got= DIM(recycle) - klen;
+         (void)memcpy(recycle + klen, iobuf, got);
+         klen+= got;
+         #endif
+         simpenc_rc4sxs_key(&r4, iobuf, got);
+         absorbed+= got;
+      }
+      if (!ferror(key) && save_fname) {
+         if (arc4_checkpoint_save(save_fname, r4.r4, absorbed)) {
+            (void)fputs("Could not write checkpoint file", stderr);
+            current_file= save_fname;
+            goto add_arg;
          }
       }
       #ifdef TESTVECTORS_PEMTFGYBNQJY1ZYR6J7I0HNUH
-      {
-         int ri= 0, left;
-         for (left= SBOX_SIZE - klen; left--; ) {
-            assert(ri < (int)DIM(recycle));
-            ARCFOUR_STEP_4_KEY((unsigned)recycle[ri]);
-            ARCFOUR_STEP_5_DROP; ARCFOUR_STEP_7_KEY;
-            if (++ri >= klen) { assert(ri == klen); ri= 0; }
+      if (klen) {
+         size_t left;
+         for (left= SBOX_SIZE - klen; left; left-= got) {
+            simpenc_rc4sxs_key(
+               &r4, recycle, got= left < klen ? left : klen
+            );
          }
       }
       #endif
@@ -291,168 +684,184 @@ int main(int argc, char **argv) {
       ;
       goto fail;
    }
-   ARCFOUR_STEP_2;
-   #ifndef TESTVECTORS_PEMTFGYBNQJY1ZYR6J7I0HNUH
-      DROP_INITIAL_KEYSTREAM();
+   #ifdef TESTVECTORS_PEMTFGYBNQJY1ZYR6J7I0HNUH
+      tv_start();
+   #else
+      stats_phase("drop");
+      simpenc_rc4sxs_start(&r4);
    #endif
    if (current_file= mac_key_fname) {
+      size_t got;
+      stats_phase("mac_key");
       if (!(key= fopen(current_file, "rb"))) {
          (void)fputs("Could not open MAC key file", stderr);
          goto add_arg;
       }
-      #define r4 mac
-         {
-            ARCFOUR_STEP_1_KEY; ARCFOUR_STEP_2;
-            {
-               int c;
-               while ((c= getc(key)) != EOF) {
-                  ASSERT_MOD256(c);
-                  ARCFOUR_STEP_4_KEY((unsigned)c);
-                  ARCFOUR_STEP_5_DROP; ARCFOUR_STEP_7_KEY;
-               }
-            }
-            if (ferror(key)) goto krderr;
-            assert(feof(key));
-            if (fclose(key)) goto exotic_error;
-         }
-      #undef r4
+      simpenc_rc4sxs_mac_init(&mac);
+      while (got= fread(iobuf, sizeof *iobuf, BUFSIZ, key)) {
+         simpenc_rc4sxs_mac_update(&mac, iobuf, got);
+      }
+      if (ferror(key)) goto krderr;
+      assert(feof(key));
+      if (fclose(key)) goto exotic_error;
       current_file= 0;
+      if (mac_threaded && pthread_create(&mac_tid, 0, mac_thread, 0)) {
+         mac_threaded= 0;
+      }
    }
+   stats_phase("bulk");
    switch (encrypt) {
-      int out;
       case 0: /* Decryption. */
          {
-            unsigned i;
+            unsigned char const *stored_mac= iobuf, *map= MAP_FAILED;
+            size_t map_size;
+            struct stat st;
+            off_t pos;
             if (
                setvbuf(stdin, 0, _IONBF, 0) || setvbuf(stdout, 0, _IONBF, 0)
             ) {
                goto exotic_error;
             }
-            for (;;) {
-               int eof;
-               unsigned stop;
-               size_t want;
-               {
-                  size_t got= fread(
-                        iobuf + prebuffered, sizeof *iobuf
-                     ,  want= DIM(iobuf) - prebuffered
-                     ,  stdin
-                  );
-                  if ((eof= got != want) && ferror(stdin)) goto rderr;
-                  assert(got <= want);
-                  got+= prebuffered;
-                  if (mac_key_fname) {
-                     if (got == MAC_OCTETS) {
-                        assert(got < want);
-                        break;
+            /* Map standard input if it is a regular file. Then the MAC
+             * position is known in advance and the ciphertext can be
+             * decrypted directly from the mapping. */
+            if (
+               !fstat(STDIN_FILENO, &st) && S_ISREG(st.st_mode)
+               && (pos= lseek(STDIN_FILENO, 0, SEEK_CUR)) >= 0
+               && pos < st.st_size && (uintmax_t)st.st_size <= SIZE_MAX
+            ) {
+               map= mmap(
+                  0, map_size= (size_t)st.st_size, PROT_READ, MAP_SHARED
+                  , STDIN_FILENO, 0
+               );
+            }
+            if (map != MAP_FAILED) {
+               size_t left= map_size - (size_t)pos;
+               unsigned char const *c= map + pos;
+               mapped= 1;
+               stats_read(left, 0); /* The mapping counts as one read. */
+               (void)posix_madvise(
+                  (void *)map, map_size, POSIX_MADV_SEQUENTIAL
+               );
+               if (mac_key_fname) {
+                  if (left < MAC_OCTETS) goto missing_mac;
+                  left-= MAC_OCTETS;
+               }
+               while (left) {
+                  size_t n= left < DIM(iobuf) ? left : DIM(iobuf);
+                  /* The mapping stays until after the MAC. */
+                  if (mac_key_fname) mac_absorb(c, n, 1);
+                  decrypt(iobuf, c, n);
+                  {
+                     uint64_t t0= stats_io_begin();
+                     if (fwrite(iobuf, sizeof *iobuf, n, stdout) != n) {
+                        goto wrerr;
                      }
-                     assert(got > MAC_OCTETS);
-                     want= got - (prebuffered= MAC_OCTETS);
-                  } else {
-                     assert(prebuffered == 0);
-                     want= got;
+                     stats_write(n, t0);
                   }
+                  c+= n; left-= n;
                }
-               stop= (unsigned)want;
-               assert(stop == want);
-               for (i= 0; i < stop; ++i) {
-                  int r;
-                  out= (int)(unsigned)iobuf[i];
-                  ASSERT_MOD256(out);
-                  if (mac_key_fname) {
-                     #define r4 mac
-                        ARCFOUR_STEP_4_KEY((unsigned)out);
-                        ARCFOUR_STEP_5_DROP; ARCFOUR_STEP_7_KEY;
-                     #undef r4
+               stored_mac= c;
+               /* Leave the file offset after the consumed input like
+                * reading it would have done, for the benefit of a
+                * process sharing the file description. */
+               if (lseek(STDIN_FILENO, 0, SEEK_END) < 0) goto exotic_error;
+            } else {
+               for (;;) {
+                  int eof;
+                  size_t want;
+                  {
+                     uint64_t t0= stats_io_begin();
+                     size_t got= fread(
+                           iobuf + prebuffered, sizeof *iobuf
+                        ,  want= DIM(iobuf) - prebuffered
+                        ,  stdin
+                     );
+                     if ((eof= got != want) && ferror(stdin)) goto rderr;
+                     stats_read(got, t0);
+                     assert(got <= want);
+                     got+= prebuffered;
+                     if (mac_key_fname) {
+                        if (got <= MAC_OCTETS) {
+                           assert(eof);
+                           prebuffered= got;
+                           break;
+                        }
+                        want= got - (prebuffered= MAC_OCTETS);
+                     } else {
+                        assert(prebuffered == 0);
+                        want= got;
+                     }
                   }
-                  #ifndef TESTVECTORS_PEMTFGYBNQJY1ZYR6J7I0HNUH
-                  CSPRNG_GET(r);
-                  ADD_MOD256(out, r);
-                  #endif
-                  CSPRNG_GET(r);
-                  out^= r;
-                  #ifndef TESTVECTORS_PEMTFGYBNQJY1ZYR6J7I0HNUH
-                  CSPRNG_GET(r);
-                  ADD_MOD256(out, r);
-                  #endif
-                  ASSERT_MOD256(out);
-                  iobuf[i]= (unsigned char)(unsigned)out;
-               }
-               if (stop) {
-                  if (fwrite(iobuf, sizeof *iobuf, want, stdout) != want) {
-                     goto wrerr;
+                  if (mac_key_fname) mac_absorb(iobuf, want, 0);
+                  decrypt(iobuf, iobuf, want);
+                  if (want) {
+                     uint64_t t0= stats_io_begin();
+                     if (fwrite(iobuf, sizeof *iobuf, want, stdout) != want) {
+                        goto wrerr;
+                     }
+                     stats_write(want, t0);
                   }
+                  (void)memmove(iobuf, iobuf + want, prebuffered);
+                  if (eof) break;
                }
-               (void)memmove(iobuf, iobuf + want, prebuffered);
-               if (eof) break;
-            }
-            if (mac_key_fname) {
-               if (prebuffered != MAC_OCTETS) {
+               if (mac_key_fname && prebuffered != MAC_OCTETS) {
                   assert(prebuffered < MAC_OCTETS);
+                  missing_mac:
                   error= "Missing MAC at end of input stream!"; goto fail;
                }
-               #define r4 mac
-                  ARCFOUR_STEP_2;
-                  DROP_INITIAL_KEYSTREAM();
-                  for (i= 0; i < MAC_OCTETS; ++i) {
-                     int r;
-                     CSPRNG_GET(out);
-                     CSPRNG_GET(r);
-                     out^= r;
-                     CSPRNG_GET(r);
-                     ADD_MOD256(out, r);
-                     ASSERT_MOD256(out);
-                     if (iobuf[i] != (unsigned)out) {
-                        error= "MAC mismatch! Message has been corrupted.";
-                        goto fail;
-                     }
-                  }
-               #undef r4
+            }
+            if (mac_key_fname) {
+               unsigned char digest[MAC_OCTETS];
+               stats_phase("mac");
+               if (mac_digest(digest)) goto exotic_error;
+               if (memcmp(stored_mac, digest, MAC_OCTETS)) {
+                  error= "MAC mismatch! Message has been corrupted.";
+                  goto fail;
+               }
+            }
+            if (map != MAP_FAILED) {
+               if (munmap((void *)map, map_size)) goto exotic_error;
             }
          }
          break;
       default: /* Encryption. */
          assert(encrypt == 1);
-         while ((out= getchar()) != EOF) {
-            {
-               int r0, r1, r2;
-               ASSERT_MOD256(out);
-               CSPRNG_GET(r0);
-               CSPRNG_GET(r1);
-               CSPRNG_GET(r2);
-               SUB_MOD256(out, r2);
-               out^= r1;
-               SUB_MOD256(out, r0);
+         if (setvbuf(stdin, 0, _IONBF, 0) || setvbuf(stdout, 0, _IONBF, 0)) {
+            goto exotic_error;
+         }
+         for (;;) {
+            /* With a MAC thread, encrypt directly in the block of the next
+             * slot of its ring, which is then passed on without a copy. */
+            unsigned char *buf= mac_threaded ? mac_slot() : iobuf;
+            uint64_t t0= stats_io_begin();
+            size_t got= fread(buf, sizeof *buf, BUFSIZ, stdin);
+            if (got != BUFSIZ && ferror(stdin)) goto rderr;
+            stats_read(got, t0);
+            encrypt_data(buf, buf, got);
+            if (mac_key_fname) mac_absorb(buf, got, 1);
+            if (got) {
+               t0= stats_io_begin();
+               if (fwrite(buf, sizeof *buf, got, stdout) != got) {
+                  goto wrerr;
+               }
+               stats_write(got, t0);
             }
-            ASSERT_MOD256(out);
-            if (putchar(out) != out) goto wrerr;
-            #define r4 mac
-               ARCFOUR_STEP_4_KEY((unsigned)out);
-               ARCFOUR_STEP_5_DROP; ARCFOUR_STEP_7_KEY;
-            #undef r4
+            if (got < BUFSIZ) break;
          }
          break;
    }
-   if (ferror(stdin)) goto rderr;
-   assert(feof(stdin));
+   if (!mapped) {
+      if (ferror(stdin)) goto rderr;
+      assert(feof(stdin));
+   }
    if (encrypt == 1 && mac_key_fname) {
-      #define r4 mac
-         ARCFOUR_STEP_2;
-         DROP_INITIAL_KEYSTREAM();
-         {
-            unsigned mac_cnt;
-            for (mac_cnt= MAC_OCTETS; mac_cnt--; ) {
-               int out, r;
-               CSPRNG_GET(out);
-               CSPRNG_GET(r);
-               out^= r;
-               CSPRNG_GET(r);
-               ADD_MOD256(out, r);
-               ASSERT_MOD256(out);
-               if (putchar(out) != out) goto wrerr;
-            }
-         }
-      #undef r4
+      stats_phase("mac");
+      if (mac_digest(iobuf)) goto exotic_error;
+      if (fwrite(iobuf, sizeof *iobuf, MAC_OCTETS, stdout) != MAC_OCTETS) {
+         goto wrerr;
+      }
+      stats_write(MAC_OCTETS, 0);
    }
    cleanup:
    if (fflush(0)) {
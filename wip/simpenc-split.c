@@ -0,0 +1,355 @@
+#define VERSTR_1 "Version 2026.290"
+#define VERSTR_2 "Copyright (c) 2026 Guenther Brunthaler."
+
+static char help[]= { /* Formatted as 66 output columns. */
+   "simpenc-split - run libsimpenc on oddly split data\n"
+   "\n"
+   "Usage: simpenc-split <algorithm> [ <argument> ... ]\n"
+   "\n"
+   "The program processes standard input with an algorithm of\n"
+   "libsimpenc and writes the result to standard output. It exists for\n"
+   "\"make check\", which compares the output with that of the tool\n"
+   "implementing the same algorithm.\n"
+   "\n"
+   "All data, including keys, is passed to the library in pieces of\n"
+   "1, 2, 3, 5, 7, 11, 13, 61, 63, 65, 127, 509, 1021, 4093 and 65537\n"
+   "octets, used cyclically. This makes sure that the output does not\n"
+   "depend on how the data is split into calls. Data is processed in\n"
+   "place.\n"
+   "\n"
+   "The standard input has the same format as for the tool, and the\n"
+   "output is the same as that of the tool with the given options:\n"
+   "\n"
+   "rc4sxs-encrypt <key> [ <mac-key> ]: rc4sxs-crypt -E <key> [ -M\n"
+   "<mac-key> ]\n"
+   "\n"
+   "rc4sxs-decrypt <key> [ <mac-key> ]: rc4sxs-crypt -D <key> [ -M\n"
+   "<mac-key> ]\n"
+   "\n"
+   "treyfer-hash <octets> [ <modes> ]: treyfer-hash -r -B <octets>,\n"
+   "plus -t if <modes> contains 't' and -T if it contains 'T'. With\n"
+   "'L' instead of 'T', every leaf of the tree mode is hashed with a\n"
+   "separate context and added by simpenc_hash_add_leaf().\n"
+   "\n"
+   "treyfer-ofb: treyfer-ofb\n"
+   "\n"
+   "treyfer-cfb-512-encrypt: treyfer-cfb-512\n"
+   "\n"
+   "treyfer-cfb-512-decrypt: treyfer-cfb-512 -d. The second half of\n"
+   "the ciphertext is decrypted by a context set up with\n"
+   "simpenc_treyfer_cfb_init_at().\n"
+   "\n"
+   "chacha20: chacha20\n"
+   "\n"
+   "-h: Display this help and exit.\n"
+   "\n"
+   "-V: Display version information and exit.\n"
+};
+
+static char version_info[]= {
+   VERSTR_1 "\n"
+   "\n"
+   VERSTR_2 " All rights reserved.\n"
+   "\n"
+   "This program is free software.\n"
+   "Distribution is permitted under the terms of the GPLv3."
+};
+
+#include "config.h"
+#include <simpenc_12xa3exh75vq0l98qouxald4m.h>
+#include <dim_sdbrke8ae851uitgzm4nv3ea2.h>
+#include <getopt_nh7lll77vb62ycgwzwf30zlln.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+static size_t const pieces[]= {
+   1, 2, 3, 5, 7, 11, 13, 61, 63, 65, 127, 509, 1021, 4093, 65537
+};
+
+/* Call <f> for consecutive pieces of the <n> octets at <p>. The sizes of
+ * the pieces continue where the previous call left off. */
+static void split(
+   unsigned char *p, size_t n, void (*f)(unsigned char *, size_t)
+) {
+   static unsigned k;
+   while (n) {
+      size_t m= pieces[k++ % DIM(pieces)];
+      if (m > n) m= n;
+      f(p, m);
+      p+= m; n-= m;
+   }
+}
+
+/* Read all of <fh> into a buffer allocated with malloc() and set <*n> to
+ * its size. Returns 0 on failure. */
+static unsigned char *read_all(FILE *fh, size_t *n) {
+   unsigned char *buf= 0;
+   size_t size= 0;
+   *n= 0;
+   for (;;) {
+      if (*n == size) {
+         unsigned char *b;
+         if (!(b= realloc(buf, size= size ? 2 * size : BUFSIZ))) break;
+         buf= b;
+      }
+      *n+= fread(buf + *n, sizeof *buf, size - *n, fh);
+      if (*n < size) {
+         if (ferror(fh)) break;
+         return buf;
+      }
+   }
+   free(buf);
+   return 0;
+}
+
+/* Like read_all() for the file <fname>. */
+static unsigned char *read_file(char const *fname, size_t *n) {
+   unsigned char *buf;
+   FILE *fh;
+   if (!(fh= fopen(fname, "rb"))) return 0;
+   buf= read_all(fh, n);
+   if (fclose(fh)) { free(buf); return 0; }
+   return buf;
+}
+
+static struct simpenc_rc4sxs rc4sxs;
+static struct simpenc_rc4sxs_mac mac;
+static int with_mac;
+static struct simpenc_hash hash, leaf;
+static struct simpenc_treyfer_ofb ofb;
+static struct simpenc_treyfer_cfb cfb;
+static struct simpenc_chacha20 cc20;
+
+static void rc4sxs_key(unsigned char *p, size_t n) {
+   simpenc_rc4sxs_key(&rc4sxs, p, n);
+}
+
+static void mac_key(unsigned char *p, size_t n) {
+   simpenc_rc4sxs_mac_update(&mac, p, n);
+}
+
+static void rc4sxs_encrypt(unsigned char *p, size_t n) {
+   simpenc_rc4sxs_encrypt(&rc4sxs, p, p, n);
+   if (with_mac) simpenc_rc4sxs_mac_update(&mac, p, n);
+}
+
+static void rc4sxs_decrypt(unsigned char *p, size_t n) {
+   if (with_mac) simpenc_rc4sxs_mac_update(&mac, p, n);
+   simpenc_rc4sxs_decrypt(&rc4sxs, p, p, n);
+}
+
+static void hash_update(unsigned char *p, size_t n) {
+   simpenc_hash_update(&hash, p, n);
+}
+
+static void leaf_update(unsigned char *p, size_t n) {
+   simpenc_hash_update(&leaf, p, n);
+}
+
+static void hash_squeeze(unsigned char *p, size_t n) {
+   simpenc_hash_squeeze(&hash, p, n);
+}
+
+static void ofb_crypt(unsigned char *p, size_t n) {
+   simpenc_treyfer_ofb_crypt(&ofb, p, p, n);
+}
+
+static void cfb_encrypt(unsigned char *p, size_t n) {
+   simpenc_treyfer_cfb_encrypt(&cfb, p, p, n);
+}
+
+static void cfb_decrypt(unsigned char *p, size_t n) {
+   simpenc_treyfer_cfb_decrypt(&cfb, p, p, n);
+}
+
+static void cc20_crypt(unsigned char *p, size_t n) {
+   simpenc_chacha20_crypt(&cc20, p, p, n);
+}
+
+/* Returns whether the <n> octets at <*p> start with the tag <c> followed
+ * by <octets> more, and advances <*p> and <*n> past the tag if so. */
+static int tagged(unsigned char **p, size_t *n, int c, size_t octets) {
+   if (*n < 1 + octets || **p != c) return 0;
+   ++*p; --*n;
+   return 1;
+}
+
+int main(int argc, char **argv) {
+   char const *error= 0, *alg;
+   unsigned char *in= 0, *out, *key= 0;
+   size_t n, out_n, key_n;
+   int a= 0;
+   {
+      int optpos= 0;
+      for (;;) {
+         int opt;
+         switch (opt= getopt_simplest(&a, &optpos, argc, argv)) {
+            case 0: goto no_more_options;
+            case 'h': (void)fputs(help, stdout); /* Fall through. */
+            case 'V':
+               if (puts(version_info) < 0) goto wrerr;
+               goto done;
+            default: getopt_simplest_perror_opt(opt); error= ""; goto leave;
+         }
+      }
+   }
+   no_more_options:
+   if (a == argc) {
+      error= "Missing algorithm! Use option -h for help."; goto fail;
+   }
+   alg= argv[a++];
+   if (!(in= read_all(stdin, &n))) {
+      error= "Error reading standard input!"; goto fail;
+   }
+   out= in; out_n= n;
+   if (
+      !strcmp(alg, "rc4sxs-encrypt") || !strcmp(alg, "rc4sxs-decrypt")
+   ) {
+      int encrypt= alg[7] == 'e';
+      unsigned char digest[SIMPENC_RC4SXS_MAC_OCTETS];
+      if (a == argc || argc - a > 2) goto bad_args;
+      if (!(key= read_file(argv[a], &key_n))) goto key_error;
+      simpenc_rc4sxs_init(&rc4sxs);
+      split(key, key_n, rc4sxs_key);
+      simpenc_rc4sxs_start(&rc4sxs);
+      free(key); key= 0;
+      if (with_mac= ++a < argc) {
+         if (!(key= read_file(argv[a], &key_n))) goto key_error;
+         simpenc_rc4sxs_mac_init(&mac);
+         split(key, key_n, mac_key);
+      }
+      if (encrypt) {
+         split(in, n, rc4sxs_encrypt);
+      } else {
+         if (with_mac) {
+            if (n < sizeof digest) {
+               error= "Missing MAC at end of input stream!"; goto fail;
+            }
+            out_n= n-= sizeof digest;
+         }
+         split(in, n, rc4sxs_decrypt);
+      }
+      if (with_mac) {
+         simpenc_rc4sxs_mac_final(&mac, digest);
+         if (encrypt) {
+            if (fwrite(in, sizeof *in, n, stdout) != n) goto wrerr;
+            out= digest; out_n= sizeof digest;
+         } else if (memcmp(in + n, digest, sizeof digest)) {
+            error= "MAC mismatch!"; goto fail;
+         }
+      }
+   } else if (!strcmp(alg, "treyfer-hash")) {
+      char const *modes;
+      unsigned flags= 0;
+      long octets;
+      if (a == argc || argc - a > 2 || (octets= atol(argv[a])) < 1) {
+         goto bad_args;
+      }
+      modes= ++a < argc ? argv[a] : "";
+      if (strchr(modes, 't')) flags|= SIMPENC_HASH_TREYFER;
+      if (strchr(modes, 'T') || strchr(modes, 'L')) {
+         flags|= SIMPENC_HASH_TREE;
+      }
+      simpenc_hash_init(&hash, flags);
+      if (strchr(modes, 'L')) {
+         size_t pos= 0;
+         do {
+            size_t m= n - pos;
+            if (m > SIMPENC_HASH_LEAF_OCTETS) m= SIMPENC_HASH_LEAF_OCTETS;
+            simpenc_hash_init(&leaf, flags & ~SIMPENC_HASH_TREE);
+            split(in + pos, m, leaf_update);
+            simpenc_hash_add_leaf(&hash, &leaf);
+            pos+= m;
+         } while (pos < n);
+      } else {
+         split(in, n, hash_update);
+      }
+      free(in);
+      if (!(in= malloc(out_n= (size_t)octets))) {
+         error= "Out of memory!"; goto fail;
+      }
+      split(out= in, out_n, hash_squeeze);
+   } else if (!strcmp(alg, "treyfer-ofb")) {
+      unsigned char *p= in, *k, *sbc;
+      if (a != argc) goto bad_args;
+      if (!tagged(&p, &n, 'K', SIMPENC_TREYFER_OFB_KEY_OCTETS)) {
+         goto bad_input;
+      }
+      k= p; p+= SIMPENC_TREYFER_OFB_KEY_OCTETS;
+      n-= SIMPENC_TREYFER_OFB_KEY_OCTETS;
+      if (!tagged(&p, &n, 'S', SIMPENC_TREYFER_OFB_SBC_OCTETS)) {
+         goto bad_input;
+      }
+      sbc= p; p+= SIMPENC_TREYFER_OFB_SBC_OCTETS;
+      n-= SIMPENC_TREYFER_OFB_SBC_OCTETS;
+      if (!tagged(&p, &n, 'I', SIMPENC_TREYFER_OFB_IV_OCTETS)) {
+         goto bad_input;
+      }
+      simpenc_treyfer_ofb_init(&ofb, k, sbc, p);
+      p+= SIMPENC_TREYFER_OFB_IV_OCTETS; n-= SIMPENC_TREYFER_OFB_IV_OCTETS;
+      if (!tagged(&p, &n, 'T', 0)) goto bad_input;
+      split(out= p, out_n= n, ofb_crypt);
+   } else if (
+      !strcmp(alg, "treyfer-cfb-512-encrypt")
+      || !strcmp(alg, "treyfer-cfb-512-decrypt")
+   ) {
+      size_t const b= SIMPENC_TREYFER_CFB_OCTETS;
+      if (a != argc) goto bad_args;
+      if (n < 2 * b) goto bad_input;
+      simpenc_treyfer_cfb_init(&cfb, in, in + b);
+      out= in + 2 * b; out_n= n-= 2 * b;
+      if (alg[16] == 'e') {
+         split(out, n, cfb_encrypt);
+      } else {
+         /* Where the second half starts. */
+         size_t m= n / 2 - n / 2 % b;
+         unsigned char prev[SIMPENC_TREYFER_CFB_OCTETS];
+         if (m) (void)memcpy(prev, out + m - b, b);
+         split(out, m, cfb_decrypt);
+         if (m) simpenc_treyfer_cfb_init_at(&cfb, in, prev, m);
+         split(out + m, n - m, cfb_decrypt);
+      }
+   } else if (!strcmp(alg, "chacha20")) {
+      unsigned char *p= in, *k;
+      unsigned rounds= 20;
+      uint64_t pos= 0;
+      if (a != argc) goto bad_args;
+      if (tagged(&p, &n, 'R', 1)) {
+         rounds= *p++; --n;
+      }
+      if (tagged(&p, &n, 'P', 8)) {
+         unsigned i;
+         for (i= 8; i--; --n) pos= pos << 8 | *p++;
+      }
+      if (!tagged(&p, &n, 'K', SIMPENC_CHACHA20_KEY_OCTETS)) {
+         goto bad_input;
+      }
+      k= p; p+= SIMPENC_CHACHA20_KEY_OCTETS;
+      n-= SIMPENC_CHACHA20_KEY_OCTETS;
+      if (!tagged(&p, &n, 'N', SIMPENC_CHACHA20_NONCE_OCTETS)) {
+         goto bad_input;
+      }
+      simpenc_chacha20_init(&cc20, k, p, rounds, pos);
+      p+= SIMPENC_CHACHA20_NONCE_OCTETS; n-= SIMPENC_CHACHA20_NONCE_OCTETS;
+      if (!tagged(&p, &n, 'D', 0)) goto bad_input;
+      split(out= p, out_n= n, cc20_crypt);
+   } else {
+      error= "Unknown algorithm! Use option -h for help."; goto fail;
+   }
+   if (fwrite(out, sizeof *out, out_n, stdout) != out_n) goto wrerr;
+   done:
+   if (fflush(0)) {
+      wrerr: error= "Write error!";
+      fail:
+      (void)fputs(error, stderr);
+      (void)fputc('\n', stderr);
+   }
+   leave:
+   free(key); free(in);
+   return error ? EXIT_FAILURE : EXIT_SUCCESS;
+   bad_args: error= "Wrong arguments for the algorithm!"; goto fail;
+   bad_input: error= "Invalid input format!"; goto fail;
+   key_error: error= "Could not read key file!"; goto fail;
+}
@@ -0,0 +1,195 @@
+/*
+ * The ARCFOUR-based algorithms of libsimpenc: rc4sxs-crypt and its MAC.
+ *
+ * The public contexts store the state of struct arc4 as plain octets. It
+ * is copied into a local struct arc4 for the duration of every call, so
+ * that the kernels can keep it in registers and the public header does
+ * not depend on "arc4_common.h".
+ *
+ * Version 2026.290
+ *
+ * Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+ *
+ * This source file is free software.
+ * Distribution is permitted under the terms of the GPLv3.
+ */
+
+#include <simpenc_12xa3exh75vq0l98qouxald4m.h>
+#include "arc4_common.h"
+#include <string.h>
+
+/* Octets of keystream generated at once, 3 for every octet of data. */
+#define KS_OCTETS (3 * 512)
+
+static void load(struct arc4 *r4, unsigned char const *state) {
+   assert(SIMPENC_ARC4_STATE_OCTETS == SBOX_SIZE + 2);
+   (void)memcpy(r4->s, state, SBOX_SIZE);
+   r4->i= state[SBOX_SIZE]; r4->j= state[SBOX_SIZE + 1];
+}
+
+static void store(unsigned char *state, struct arc4 const *r4) {
+   (void)memcpy(state, r4->s, SBOX_SIZE);
+   state[SBOX_SIZE]= r4->i; state[SBOX_SIZE + 1]= r4->j;
+}
+
+/* Like load() and store() for SIMPENC_RC4SXS_LANES contexts. */
+static void load_lanes(struct arc4 *r4, struct simpenc_rc4sxs const *ctx) {
+   unsigned k;
+   assert(SIMPENC_RC4SXS_LANES == ARC4_LANES);
+   for (k= ARC4_LANES; k--; ) load(&r4[k], ctx[k].r4);
+}
+
+static void store_lanes(struct simpenc_rc4sxs *ctx, struct arc4 const *r4) {
+   unsigned k;
+   for (k= ARC4_LANES; k--; ) store(ctx[k].r4, &r4[k]);
+}
+
+static void init(unsigned char *state) {
+   struct arc4 r4;
+   arc4_init(&r4);
+   store(state, &r4);
+}
+
+static void absorb(unsigned char *state, void const *data, size_t octets) {
+   struct arc4 r4;
+   load(&r4, state);
+   arc4_absorb(&r4, data, octets);
+   store(state, &r4);
+}
+
+void simpenc_rc4sxs_init(struct simpenc_rc4sxs *ctx) {
+   init(ctx->r4);
+}
+
+void simpenc_rc4sxs_key(
+   struct simpenc_rc4sxs *ctx, void const *key, size_t octets
+) {
+   absorb(ctx->r4, key, octets);
+}
+
+void simpenc_rc4sxs_start(struct simpenc_rc4sxs *ctx) {
+   struct arc4 r4;
+   load(&r4, ctx->r4);
+   arc4_end_key(&r4);
+   arc4_drop(&r4, DROP_N);
+   store(ctx->r4, &r4);
+}
+
+void simpenc_rc4sxs_encrypt(
+   struct simpenc_rc4sxs *ctx, void *dst, void const *src, size_t octets
+) {
+   unsigned char ks[KS_OCTETS], *d= dst;
+   unsigned char const *s= src;
+   struct arc4 r4;
+   load(&r4, ctx->r4);
+   while (octets) {
+      size_t n= octets < KS_OCTETS / 3 ? octets : KS_OCTETS / 3;
+      arc4_generate(&r4, ks, 3 * n);
+      arc4_sxs_encrypt(d, s, ks, n);
+      d+= n; s+= n; octets-= n;
+   }
+   store(ctx->r4, &r4);
+}
+
+void simpenc_rc4sxs_decrypt(
+   struct simpenc_rc4sxs *ctx, void *dst, void const *src, size_t octets
+) {
+   unsigned char ks[KS_OCTETS], *d= dst;
+   unsigned char const *s= src;
+   struct arc4 r4;
+   load(&r4, ctx->r4);
+   while (octets) {
+      size_t n= octets < KS_OCTETS / 3 ? octets : KS_OCTETS / 3;
+      arc4_generate(&r4, ks, 3 * n);
+      arc4_sxs_decrypt(d, s, ks, n);
+      d+= n; s+= n; octets-= n;
+   }
+   store(ctx->r4, &r4);
+}
+
+void simpenc_rc4sxs_key_lanes(
+   struct simpenc_rc4sxs *ctx, void const *const *key, size_t const *octets
+) {
+   struct arc4 r4[ARC4_LANES];
+   load_lanes(r4, ctx);
+   arc4_absorb_lanes(r4, (unsigned char const *const *)key, octets);
+   store_lanes(ctx, r4);
+}
+
+void simpenc_rc4sxs_start_lanes(struct simpenc_rc4sxs *ctx) {
+   struct arc4 r4[ARC4_LANES];
+   unsigned k;
+   load_lanes(r4, ctx);
+   for (k= ARC4_LANES; k--; ) arc4_end_key(&r4[k]);
+   arc4_drop_lanes(r4, DROP_N);
+   store_lanes(ctx, r4);
+}
+
+/* Encrypt or decrypt with every lane, processing at most KS_OCTETS / 3
+ * octets of every lane at a time. */
+static void crypt_lanes(
+   struct simpenc_rc4sxs *ctx, void *const *dst, void const *const *src
+   , size_t const *octets, int encrypt
+) {
+   unsigned char ks[ARC4_LANES][KS_OCTETS], *out[ARC4_LANES];
+   unsigned char *d[ARC4_LANES];
+   unsigned char const *s[ARC4_LANES];
+   size_t left[ARC4_LANES], n[ARC4_LANES], ns[ARC4_LANES];
+   struct arc4 r4[ARC4_LANES];
+   unsigned k;
+   load_lanes(r4, ctx);
+   for (k= ARC4_LANES; k--; ) {
+      d[k]= dst[k]; s[k]= src[k]; left[k]= octets[k]; out[k]= ks[k];
+   }
+   for (;;) {
+      int more= 0;
+      for (k= ARC4_LANES; k--; ) {
+         n[k]= left[k] < KS_OCTETS / 3 ? left[k] : KS_OCTETS / 3;
+         ns[k]= 3 * n[k];
+         if (n[k]) more= 1;
+      }
+      if (!more) break;
+      arc4_generate_lanes(r4, out, ns);
+      for (k= ARC4_LANES; k--; ) {
+         (encrypt ? arc4_sxs_encrypt : arc4_sxs_decrypt)(
+            d[k], s[k], ks[k], n[k]
+         );
+         d[k]+= n[k]; s[k]+= n[k]; left[k]-= n[k];
+      }
+   }
+   store_lanes(ctx, r4);
+}
+
+void simpenc_rc4sxs_encrypt_lanes(
+   struct simpenc_rc4sxs *ctx, void *const *dst, void const *const *src
+   , size_t const *octets
+) {
+   crypt_lanes(ctx, dst, src, octets, 1);
+}
+
+void simpenc_rc4sxs_decrypt_lanes(
+   struct simpenc_rc4sxs *ctx, void *const *dst, void const *const *src
+   , size_t const *octets
+) {
+   crypt_lanes(ctx, dst, src, octets, 0);
+}
+
+void simpenc_rc4sxs_mac_init(struct simpenc_rc4sxs_mac *ctx) {
+   init(ctx->r4);
+}
+
+void simpenc_rc4sxs_mac_update(
+   struct simpenc_rc4sxs_mac *ctx, void const *data, size_t octets
+) {
+   absorb(ctx->r4, data, octets);
+}
+
+void simpenc_rc4sxs_mac_final(
+   struct simpenc_rc4sxs_mac *ctx, unsigned char *mac
+) {
+   struct arc4 r4;
+   assert(SIMPENC_RC4SXS_MAC_OCTETS == ARC4_MAC_OCTETS);
+   load(&r4, ctx->r4);
+   arc4_mac_final(&r4, mac);
+   (void)memset(ctx->r4, 0, sizeof ctx->r4);
+}
@@ -0,0 +1,108 @@
+/*
+ * ChaCha20 for libsimpenc, compatible with the chacha20 tool. The tool
+ * itself has SIMD kernels and run-time CPU dispatch, which need the
+ * configure checks of its own build system. This is the portable scalar
+ * version of the same algorithm. Whole keystream blocks are XORed into the
+ * data in machine words; only partial blocks at the start and the end of
+ * a call are processed octet by octet.
+ *
+ * Version 2026.290
+ *
+ * Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+ *
+ * This source file is free software.
+ * Distribution is permitted under the terms of the GPLv3.
+ */
+
+#include <simpenc_12xa3exh75vq0l98qouxald4m.h>
+#include <string.h>
+#include <assert.h>
+
+/* Offsets of the words within the state. */
+#define CONST_O 0
+#define KEY_O 4
+#define POS_O 12
+#define NONCE_O 14
+
+#define ROTL32(w, n) ((w) << (n) | (w) >> 32 - (n))
+
+#define QUARTER_ROUND(a, b, c, d) \
+   a+= b; d^= a; d= ROTL32(d, 16); \
+   c+= d; b^= c; b= ROTL32(b, 12); \
+   a+= b; d^= a; d= ROTL32(d, 8); \
+   c+= d; b^= c; b= ROTL32(b, 7)
+
+static uint32_t le32(unsigned char const *p) {
+   return
+      (uint32_t)p[0] | (uint32_t)p[1] << 8
+      | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24
+   ;
+}
+
+/* Generate the next keystream block into <ctx->ks> and advance the block
+ * counter. */
+static void next_block(struct simpenc_chacha20 *ctx) {
+   uint32_t x[16], *in= ctx->state;
+   unsigned k;
+   for (k= 16; k--; ) x[k]= in[k];
+   for (k= ctx->rounds / 2; k--; ) {
+      QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+      QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+      QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+      QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+      QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+      QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+      QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+      QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+   }
+   for (k= 16; k--; ) {
+      uint32_t w= x[k] + in[k];
+      unsigned char *o= ctx->ks + 4 * k;
+      o[0]= (unsigned char)(w & 0xff); o[1]= (unsigned char)(w >> 8 & 0xff);
+      o[2]= (unsigned char)(w >> 16 & 0xff); o[3]= (unsigned char)(w >> 24);
+   }
+   if (!++in[POS_O]) ++in[POS_O + 1];
+   ctx->used= 0;
+}
+
+void simpenc_chacha20_init(
+   struct simpenc_chacha20 *ctx, unsigned char const *key
+   , unsigned char const *nonce, unsigned rounds, uint64_t pos
+) {
+   static unsigned char const as_good_as_any[]= {"expand 32-byte k"};
+   unsigned k;
+   assert(rounds == 20 || rounds == 12 || rounds == 8);
+   for (k= 4; k--; ) ctx->state[CONST_O + k]= le32(as_good_as_any + 4 * k);
+   for (k= 8; k--; ) ctx->state[KEY_O + k]= le32(key + 4 * k);
+   ctx->state[POS_O]= (uint32_t)pos;
+   ctx->state[POS_O + 1]= (uint32_t)(pos >> 32);
+   for (k= 2; k--; ) ctx->state[NONCE_O + k]= le32(nonce + 4 * k);
+   ctx->rounds= rounds;
+   ctx->used= SIMPENC_CHACHA20_BLOCK_OCTETS;
+}
+
+void simpenc_chacha20_crypt(
+   struct simpenc_chacha20 *ctx, void *dst, void const *src, size_t octets
+) {
+   unsigned char *d= dst;
+   unsigned char const *s= src;
+   /* Use up the rest of the current keystream block. */
+   while (octets && ctx->used < SIMPENC_CHACHA20_BLOCK_OCTETS) {
+      *d++= *s++ ^ ctx->ks[ctx->used++]; --octets;
+   }
+   while (octets >= SIMPENC_CHACHA20_BLOCK_OCTETS) {
+      size_t w[SIMPENC_CHACHA20_BLOCK_OCTETS / sizeof(size_t)];
+      size_t k[SIMPENC_CHACHA20_BLOCK_OCTETS / sizeof(size_t)];
+      unsigned i;
+      next_block(ctx);
+      (void)memcpy(w, s, sizeof w); (void)memcpy(k, ctx->ks, sizeof k);
+      for (i= (unsigned)(sizeof w / sizeof *w); i--; ) w[i]^= k[i];
+      (void)memcpy(d, w, sizeof w);
+      ctx->used= SIMPENC_CHACHA20_BLOCK_OCTETS;
+      d+= sizeof w; s+= sizeof w; octets-= sizeof w;
+   }
+   if (octets) {
+      next_block(ctx);
+      while (octets--) *d++= *s++ ^ ctx->ks[ctx->used++];
+   }
+}
@@ -0,0 +1,16 @@
+arc4.o: ../arc4_common.h
+arc4.o: ../fragments/include/dim_sdbrke8ae851uitgzm4nv3ea2.h
+arc4.o: arc4.c
+arc4.o: include/simpenc_12xa3exh75vq0l98qouxald4m.h
+chacha20.o: chacha20.c
+chacha20.o: include/simpenc_12xa3exh75vq0l98qouxald4m.h
+hash.o: ../arc4_common.h
+hash.o: ../fragments/include/dim_sdbrke8ae851uitgzm4nv3ea2.h
+hash.o: ../treyfer_common.h
+hash.o: ../treyfer_sbox.h
+hash.o: hash.c
+hash.o: include/simpenc_12xa3exh75vq0l98qouxald4m.h
+treyfer.o: ../treyfer_common.h
+treyfer.o: ../treyfer_sbox.h
+treyfer.o: include/simpenc_12xa3exh75vq0l98qouxald4m.h
+treyfer.o: treyfer.c
@@ -0,0 +1,205 @@
+/*
+ * The hash of treyfer-hash for libsimpenc, with both of its engines and
+ * its tree mode.
+ *
+ * Like in arc4.c, the public contexts store the state of the engines as
+ * plain members. It is copied into the structures of "arc4_common.h" and
+ * "treyfer_common.h" for the duration of every call.
+ *
+ * Version 2026.290
+ *
+ * Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+ *
+ * This source file is free software.
+ * Distribution is permitted under the terms of the GPLv3.
+ */
+
+#include <simpenc_12xa3exh75vq0l98qouxald4m.h>
+#include "arc4_common.h"
+#include "treyfer_common.h"
+#include "treyfer_sbox.h"
+#include <string.h>
+
+/* Tree mode: The message of a leaf is its data followed by the octet
+ * LEAF_DOMAIN, and its digest is the first LEAF_DIGEST_OCTETS of the hash
+ * of it. The message of the root is the concatenation of the digests of
+ * all leaves, followed by the length of the input as a 64-bit
+ * little-endian integer and the octet ROOT_DOMAIN. The hash of the root
+ * message is then used like the hash of the input without tree mode. */
+#define LEAF_DIGEST_OCTETS 64
+#define LEAF_DOMAIN 0x00
+#define ROOT_DOMAIN 0x01
+
+union engine {
+   struct arc4 r4;
+   struct treyfer_hash th;
+};
+
+static void load(
+   union engine *e, union simpenc_hash_engine const *h, unsigned flags
+) {
+   if (flags & SIMPENC_HASH_TREYFER) {
+      assert(sizeof h->treyfer.digest == TREYFER_512_OCTETS);
+      (void)memcpy(e->th.digest, h->treyfer.digest, TREYFER_512_OCTETS);
+      (void)memcpy(e->th.block, h->treyfer.block, TREYFER_512_OCTETS);
+      e->th.used= h->treyfer.used; e->th.octets= h->treyfer.octets;
+   } else {
+      assert(SIMPENC_ARC4_STATE_OCTETS == SBOX_SIZE + 2);
+      (void)memcpy(e->r4.s, h->r4, SBOX_SIZE);
+      e->r4.i= h->r4[SBOX_SIZE]; e->r4.j= h->r4[SBOX_SIZE + 1];
+   }
+}
+
+static void store(
+   union simpenc_hash_engine *h, union engine const *e, unsigned flags
+) {
+   if (flags & SIMPENC_HASH_TREYFER) {
+      (void)memcpy(h->treyfer.digest, e->th.digest, TREYFER_512_OCTETS);
+      (void)memcpy(h->treyfer.block, e->th.block, TREYFER_512_OCTETS);
+      h->treyfer.used= e->th.used; h->treyfer.octets= e->th.octets;
+   } else {
+      (void)memcpy(h->r4, e->r4.s, SBOX_SIZE);
+      h->r4[SBOX_SIZE]= e->r4.i; h->r4[SBOX_SIZE + 1]= e->r4.j;
+   }
+}
+
+static void engine_init(union simpenc_hash_engine *h, unsigned flags) {
+   union engine e;
+   if (flags & SIMPENC_HASH_TREYFER) treyfer_hash_init(&e.th);
+   else arc4_init(&e.r4);
+   store(h, &e, flags);
+}
+
+static void engine_update(
+   union simpenc_hash_engine *h, void const *data, size_t octets
+   , unsigned flags
+) {
+   union engine e;
+   load(&e, h, flags);
+   if (flags & SIMPENC_HASH_TREYFER) {
+      treyfer_hash_update(
+         &e.th, data, octets, (unsigned char const *)sbox
+      );
+   } else {
+      arc4_absorb(&e.r4, data, octets);
+   }
+   store(h, &e, flags);
+}
+
+static void engine_end(union simpenc_hash_engine *h, unsigned flags) {
+   union engine e;
+   load(&e, h, flags);
+   if (flags & SIMPENC_HASH_TREYFER) {
+      treyfer_hash_final(&e.th, (unsigned char const *)sbox);
+   } else {
+      /* Finish key setup and drop the initial pseudorandom output. */
+      arc4_end_key(&e.r4);
+      arc4_drop(&e.r4, DROP_N);
+   }
+   store(h, &e, flags);
+}
+
+static void engine_squeeze(
+   union simpenc_hash_engine *h, unsigned char *out, size_t octets
+   , unsigned flags
+) {
+   union engine e;
+   load(&e, h, flags);
+   if (flags & SIMPENC_HASH_TREYFER) {
+      treyfer_hash_squeeze(&e.th, out, octets, (unsigned char const *)sbox);
+   } else {
+      arc4_generate(&e.r4, out, octets);
+   }
+   store(h, &e, flags);
+}
+
+/* End the message of the leaf hash <leaf> and add its digest to the root
+ * message <root>. */
+static void add_leaf(
+   union simpenc_hash_engine *root, union simpenc_hash_engine *leaf
+   , unsigned flags
+) {
+   static unsigned char const domain= LEAF_DOMAIN;
+   unsigned char digest[LEAF_DIGEST_OCTETS];
+   engine_update(leaf, &domain, 1, flags);
+   engine_end(leaf, flags);
+   engine_squeeze(leaf, digest, sizeof digest, flags);
+   engine_update(root, digest, sizeof digest, flags);
+}
+
+void simpenc_hash_init(struct simpenc_hash *ctx, unsigned flags) {
+   engine_init(&ctx->h, flags);
+   if (flags & SIMPENC_HASH_TREE) engine_init(&ctx->leaf, flags);
+   ctx->octets= ctx->leaves= 0;
+   ctx->flags= flags; ctx->ended= 0;
+}
+
+void simpenc_hash_update(
+   struct simpenc_hash *ctx, void const *data, size_t octets
+) {
+   unsigned char const *p= data;
+   assert(!ctx->ended);
+   if (!(ctx->flags & SIMPENC_HASH_TREE)) {
+      engine_update(&ctx->h, data, octets, ctx->flags);
+      ctx->octets+= octets;
+      return;
+   }
+   while (octets) {
+      /* The full leaves have already been added to the root. */
+      size_t fill= (size_t)(
+         ctx->octets - ctx->leaves * SIMPENC_HASH_LEAF_OCTETS
+      );
+      size_t n= SIMPENC_HASH_LEAF_OCTETS - fill;
+      if (n > octets) n= octets;
+      engine_update(&ctx->leaf, p, n, ctx->flags);
+      p+= n; octets-= n; ctx->octets+= n;
+      if (fill + n == SIMPENC_HASH_LEAF_OCTETS) {
+         add_leaf(&ctx->h, &ctx->leaf, ctx->flags);
+         engine_init(&ctx->leaf, ctx->flags);
+         ++ctx->leaves;
+      }
+   }
+}
+
+void simpenc_hash_add_leaf(
+   struct simpenc_hash *ctx, struct simpenc_hash *leaf
+) {
+   assert(ctx->flags & SIMPENC_HASH_TREE);
+   assert(ctx->octets == ctx->leaves * SIMPENC_HASH_LEAF_OCTETS);
+   assert(leaf->flags == (ctx->flags & ~SIMPENC_HASH_TREE));
+   assert(!leaf->ended);
+   assert(leaf->octets <= SIMPENC_HASH_LEAF_OCTETS);
+   add_leaf(&ctx->h, &leaf->h, ctx->flags);
+   ctx->octets+= leaf->octets; ++ctx->leaves;
+   leaf->ended= 1;
+}
+
+void simpenc_hash_end(struct simpenc_hash *ctx) {
+   assert(!ctx->ended);
+   if (ctx->flags & SIMPENC_HASH_TREE) {
+      unsigned char end[8 + 1];
+      unsigned k;
+      /* Add the current leaf unless it is empty, but an empty input has
+       * a single empty leaf. */
+      if (
+         ctx->octets > ctx->leaves * SIMPENC_HASH_LEAF_OCTETS
+         || !ctx->leaves
+      ) {
+         add_leaf(&ctx->h, &ctx->leaf, ctx->flags);
+      }
+      for (k= 0; k < 8; ++k) {
+         end[k]= (unsigned char)(ctx->octets >> 8 * k & 0xff);
+      }
+      end[8]= ROOT_DOMAIN;
+      engine_update(&ctx->h, end, sizeof end, ctx->flags);
+   }
+   engine_end(&ctx->h, ctx->flags);
+   ctx->ended= 1;
+}
+
+void simpenc_hash_squeeze(
+   struct simpenc_hash *ctx, unsigned char *digest, size_t octets
+) {
+   if (!ctx->ended) simpenc_hash_end(ctx);
+   engine_squeeze(&ctx->h, digest, octets, ctx->flags);
+}
@@ -0,0 +1,268 @@
+/*
+ * #include <simpenc_12xa3exh75vq0l98qouxald4m.h>
+ *
+ * libsimpenc: The algorithms of the simpenc tools for use within a process.
+ *
+ * Every algorithm works on a context which is provided by the caller and
+ * holds its complete state, so any number of independent instances can
+ * be used side by side, also in different threads. The library has no
+ * global state and does no memory allocation or I/O of its own. The
+ * output is always the same as that of the respective tool, no matter how
+ * the data is split into calls.
+ *
+ * Where <dst> and <src> are both arguments, they may be the same buffer
+ * for processing in place, but must not overlap otherwise.
+ *
+ * Version 2026.290
+ *
+ * Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+ *
+ * This source file is free software.
+ * Distribution is permitted under the terms of the GPLv3.
+ */
+
+
+#ifndef HEADER_12XA3EXH75VQ0L98QOUXALD4M_INCLUDED
+#define HEADER_12XA3EXH75VQ0L98QOUXALD4M_INCLUDED
+#ifdef __cplusplus
+   extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* Octets of the state of an ARCFOUR instance: The S-box, then i and j.
+ * While the key is being set up, this is also the start of the checkpoints
+ * of "rc4sxs-crypt -S" and "treyfer-hash -S", so the <r4> member of the
+ * contexts below may be saved and restored at that time. */
+#define SIMPENC_ARC4_STATE_OCTETS (256 + 2)
+
+
+/* rc4sxs-crypt: ARCFOUR-drop3072 with the modified key schedule, combined
+ * with the data by SUBTRACT-XOR-SUBTRACT. Call simpenc_rc4sxs_init(), then
+ * simpenc_rc4sxs_key() for all of the one-time key, split as convenient,
+ * then simpenc_rc4sxs_start(). After that, either encrypt or decrypt any
+ * amount of data. */
+struct simpenc_rc4sxs {
+   unsigned char r4[SIMPENC_ARC4_STATE_OCTETS];
+};
+
+void simpenc_rc4sxs_init(struct simpenc_rc4sxs *ctx);
+
+void simpenc_rc4sxs_key(
+   struct simpenc_rc4sxs *ctx, void const *key, size_t octets
+);
+
+void simpenc_rc4sxs_start(struct simpenc_rc4sxs *ctx);
+
+void simpenc_rc4sxs_encrypt(
+   struct simpenc_rc4sxs *ctx, void *dst, void const *src, size_t octets
+);
+
+void simpenc_rc4sxs_decrypt(
+   struct simpenc_rc4sxs *ctx, void *dst, void const *src, size_t octets
+);
+
+/* The same for SIMPENC_RC4SXS_LANES independent instances <ctx>[0] through
+ * <ctx>[SIMPENC_RC4SXS_LANES - 1] at once, which is faster than processing
+ * them one after another. Every instance has its own key, data and number
+ * of octets at the same index of the array arguments. */
+#define SIMPENC_RC4SXS_LANES 4
+
+void simpenc_rc4sxs_key_lanes(
+   struct simpenc_rc4sxs *ctx, void const *const *key, size_t const *octets
+);
+
+void simpenc_rc4sxs_start_lanes(struct simpenc_rc4sxs *ctx);
+
+void simpenc_rc4sxs_encrypt_lanes(
+   struct simpenc_rc4sxs *ctx, void *const *dst, void const *const *src
+   , size_t const *octets
+);
+
+void simpenc_rc4sxs_decrypt_lanes(
+   struct simpenc_rc4sxs *ctx, void *const *dst, void const *const *src
+   , size_t const *octets
+);
+
+
+/* The MAC of "rc4sxs-crypt -M". Feed the one-time MAC key and then the
+ * ciphertext to simpenc_rc4sxs_mac_update(), then get the MAC from
+ * simpenc_rc4sxs_mac_final(), which leaves the context unusable until it
+ * is initialized again. */
+#define SIMPENC_RC4SXS_MAC_OCTETS 32
+
+struct simpenc_rc4sxs_mac {
+   unsigned char r4[SIMPENC_ARC4_STATE_OCTETS];
+};
+
+void simpenc_rc4sxs_mac_init(struct simpenc_rc4sxs_mac *ctx);
+
+void simpenc_rc4sxs_mac_update(
+   struct simpenc_rc4sxs_mac *ctx, void const *data, size_t octets
+);
+
+void simpenc_rc4sxs_mac_final(
+   struct simpenc_rc4sxs_mac *ctx, unsigned char *mac
+);
+
+
+/* The hash of treyfer-hash as raw octets ("treyfer-hash -r"). <flags>
+ * selects the variant: SIMPENC_HASH_TREYFER for the Treyfer-512 engine of
+ * "treyfer-hash -t" instead of ARCFOUR, and SIMPENC_HASH_TREE for the tree
+ * mode of "treyfer-hash -T". Feed the message to simpenc_hash_update(),
+ * then read as many octets of digest as required by one or more calls of
+ * simpenc_hash_squeeze(). simpenc_hash_end() ends the message; the first
+ * call of simpenc_hash_squeeze() does that if it has not been called. */
+#define SIMPENC_HASH_TREYFER 1
+#define SIMPENC_HASH_TREE 2
+
+/* The state of either engine. */
+union simpenc_hash_engine {
+   unsigned char r4[SIMPENC_ARC4_STATE_OCTETS];
+   struct {
+      unsigned char digest[64], block[64];
+      unsigned used;
+      uint64_t octets;
+   } treyfer;
+};
+
+struct simpenc_hash {
+   union simpenc_hash_engine h;
+   union simpenc_hash_engine leaf; /* The current leaf in tree mode. */
+   uint64_t octets, leaves;
+   unsigned flags;
+   int ended;
+};
+
+void simpenc_hash_init(struct simpenc_hash *ctx, unsigned flags);
+
+void simpenc_hash_update(
+   struct simpenc_hash *ctx, void const *data, size_t octets
+);
+
+void simpenc_hash_end(struct simpenc_hash *ctx);
+
+void simpenc_hash_squeeze(
+   struct simpenc_hash *ctx, unsigned char *digest, size_t octets
+);
+
+/* In tree mode, the input is cut into leaves of SIMPENC_HASH_LEAF_OCTETS,
+ * which are hashed separately. They can also be hashed independently, such
+ * as in parallel: Hash the data of every leaf with a separate context
+ * which has been initialized without SIMPENC_HASH_TREE, and pass it to
+ * simpenc_hash_add_leaf() in the order of the leaves instead of passing
+ * the data to simpenc_hash_update() of the tree-mode <ctx>. All leaves but
+ * the last one must be full, and an empty input has a single empty leaf.
+ * <leaf> is unusable afterwards. */
+#define SIMPENC_HASH_LEAF_OCTETS (1024 * 1024)
+
+void simpenc_hash_add_leaf(
+   struct simpenc_hash *ctx, struct simpenc_hash *leaf
+);
+
+
+/* treyfer-ofb: Treyfer with 64-bit blocks and a configurable S-box in OFB
+ * mode. Encryption and decryption are the same operation. <sbc> is the
+ * S-box configuration as described in the help of treyfer-ofb. The S-box
+ * which has been constructed from it is available as <sbox>. */
+#define SIMPENC_TREYFER_OFB_KEY_OCTETS 8
+#define SIMPENC_TREYFER_OFB_SBC_OCTETS 256
+#define SIMPENC_TREYFER_OFB_IV_OCTETS 8
+
+struct simpenc_treyfer_ofb {
+   unsigned char sbox[SIMPENC_TREYFER_OFB_SBC_OCTETS];
+   unsigned char key[SIMPENC_TREYFER_OFB_KEY_OCTETS];
+   unsigned char block[SIMPENC_TREYFER_OFB_IV_OCTETS];
+   unsigned used;
+};
+
+void simpenc_treyfer_ofb_init(
+   struct simpenc_treyfer_ofb *ctx, unsigned char const *key
+   , unsigned char const *sbc, unsigned char const *iv
+);
+
+void simpenc_treyfer_ofb_crypt(
+   struct simpenc_treyfer_ofb *ctx, void *dst, void const *src
+   , size_t octets
+);
+
+
+/* treyfer-cfb-512: Treyfer with 512-bit blocks and keys and the S-box
+ * derived from pi in a CFB mode which is weaker than real CFB.
+ *
+ * Warning: For compatibility with the existing output format, the feedback
+ * block is not encrypted again at the start of every segment of 64 KiB of
+ * data. The first 64 octets of every segment after the first one are
+ * therefore only the plaintext XORed with the previous ciphertext block,
+ * which anyone can undo without knowing the key. For instance, if the
+ * plaintext is all zeros, ciphertext block 1024 equals block 1023. */
+#define SIMPENC_TREYFER_CFB_OCTETS 64
+
+struct simpenc_treyfer_cfb {
+   unsigned char key[SIMPENC_TREYFER_CFB_OCTETS];
+   unsigned char block[SIMPENC_TREYFER_CFB_OCTETS];
+   unsigned pos;
+};
+
+void simpenc_treyfer_cfb_init(
+   struct simpenc_treyfer_cfb *ctx, unsigned char const *key
+   , unsigned char const *iv
+);
+
+void simpenc_treyfer_cfb_encrypt(
+   struct simpenc_treyfer_cfb *ctx, void *dst, void const *src
+   , size_t octets
+);
+
+void simpenc_treyfer_cfb_decrypt(
+   struct simpenc_treyfer_cfb *ctx, void *dst, void const *src
+   , size_t octets
+);
+
+/* Set up <ctx> like simpenc_treyfer_cfb_init() followed by decrypting
+ * the first <offset> octets of the ciphertext, given only the 64 octets
+ * of ciphertext preceding <offset> in <prev>. <offset> must be a positive
+ * multiple of SIMPENC_TREYFER_CFB_OCTETS. This allows to decrypt different
+ * parts of a message independently, such as in parallel. */
+void simpenc_treyfer_cfb_init_at(
+   struct simpenc_treyfer_cfb *ctx, unsigned char const *key
+   , unsigned char const *prev, uint64_t offset
+);
+
+
+/* ChaCha20 with a 64-bit nonce and a 64-bit block counter like the
+ * chacha20 tool. <rounds> is 20, 12 or 8, and <pos> is the number of the
+ * first keystream block (the 'P' parameter of the tool). Encryption and
+ * decryption are the same operation.
+ *
+ * This is a portable implementation which computes a single block at a
+ * time and XORs whole blocks into the data with word-sized operations. It
+ * is several times slower than the chacha20 tool, which computes 4 to 16
+ * blocks at once with SIMD instructions selected at run time; those need
+ * the configure checks of the tool's own build system. */
+#define SIMPENC_CHACHA20_KEY_OCTETS 32
+#define SIMPENC_CHACHA20_NONCE_OCTETS 8
+#define SIMPENC_CHACHA20_BLOCK_OCTETS 64
+
+struct simpenc_chacha20 {
+   uint32_t state[16];
+   unsigned char ks[SIMPENC_CHACHA20_BLOCK_OCTETS];
+   unsigned rounds, used;
+};
+
+void simpenc_chacha20_init(
+   struct simpenc_chacha20 *ctx, unsigned char const *key
+   , unsigned char const *nonce, unsigned rounds, uint64_t pos
+);
+
+void simpenc_chacha20_crypt(
+   struct simpenc_chacha20 *ctx, void *dst, void const *src, size_t octets
+);
+
+
+#ifdef __cplusplus
+   }
+#endif
+#endif /* !HEADER_12XA3EXH75VQ0L98QOUXALD4M_INCLUDED */
@@ -0,0 +1,6 @@
+SOURCES = \
+	arc4.c \
+	chacha20.c \
+	hash.c \
+	treyfer.c \
+
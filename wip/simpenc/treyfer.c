@@ -0,0 +1,124 @@
+/*
+ * The Treyfer-based ciphers of libsimpenc: treyfer-ofb and treyfer-cfb-512.
+ *
+ * Version 2026.290
+ *
+ * Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+ *
+ * This source file is free software.
+ * Distribution is permitted under the terms of the GPLv3.
+ */
+
+#include <simpenc_12xa3exh75vq0l98qouxald4m.h>
+#include "treyfer_common.h"
+#include "treyfer_sbox.h"
+#include <string.h>
+#include <assert.h>
+
+/* treyfer-cfb-512 does not encrypt the feedback block again before the
+ * first segment of every 64 KiB of data, which has been the size of its
+ * I/O buffer. This is part of its output format now. */
+#define CFB_SEGMENT_OCTETS (64 * 1024)
+
+void simpenc_treyfer_ofb_init(
+   struct simpenc_treyfer_ofb *ctx, unsigned char const *key
+   , unsigned char const *sbc, unsigned char const *iv
+) {
+   unsigned n;
+   /* Preset identity substitution, then swap as configured. */
+   for (n= SIMPENC_TREYFER_OFB_SBC_OCTETS; n--; ) {
+      ctx->sbox[n]= (unsigned char)n;
+   }
+   for (n= 0; n < SIMPENC_TREYFER_OFB_SBC_OCTETS; ++n) {
+      unsigned char t= ctx->sbox[sbc[n]];
+      ctx->sbox[sbc[n]]= ctx->sbox[n]; ctx->sbox[n]= t;
+   }
+   (void)memcpy(ctx->key, key, sizeof ctx->key);
+   (void)memcpy(ctx->block, iv, sizeof ctx->block);
+   ctx->used= 0;
+}
+
+void simpenc_treyfer_ofb_crypt(
+   struct simpenc_treyfer_ofb *ctx, void *dst, void const *src
+   , size_t octets
+) {
+   unsigned char *d= dst;
+   unsigned char const *s= src;
+   unsigned used= ctx->used;
+   assert(sizeof ctx->block == TREYFER_64_OCTETS);
+   while (octets--) {
+      if (used == 0) treyfer_encrypt_64(ctx->block, ctx->key, ctx->sbox);
+      *d++= *s++ ^ ctx->block[used];
+      used= TREYFER_MOD(used + 1, TREYFER_64_OCTETS);
+   }
+   ctx->used= used;
+}
+
+void simpenc_treyfer_cfb_init(
+   struct simpenc_treyfer_cfb *ctx, unsigned char const *key
+   , unsigned char const *iv
+) {
+   (void)memcpy(ctx->key, key, sizeof ctx->key);
+   (void)memcpy(ctx->block, iv, sizeof ctx->block);
+   treyfer_encrypt_512(
+      ctx->block, ctx->key, (unsigned char const *)sbox
+   );
+   ctx->pos= 0;
+}
+
+/* Get the feedback block ready for the octet at <pos>, which is the
+ * offset within the current 64 KiB. */
+static void cfb_next(struct simpenc_treyfer_cfb *ctx, unsigned pos) {
+   assert(sizeof ctx->block == TREYFER_512_OCTETS);
+   if (pos && TREYFER_MOD(pos, TREYFER_512_OCTETS) == 0) {
+      treyfer_encrypt_512(
+         ctx->block, ctx->key, (unsigned char const *)sbox
+      );
+   }
+}
+
+void simpenc_treyfer_cfb_encrypt(
+   struct simpenc_treyfer_cfb *ctx, void *dst, void const *src
+   , size_t octets
+) {
+   unsigned char *d= dst;
+   unsigned char const *s= src;
+   unsigned pos= ctx->pos;
+   while (octets--) {
+      unsigned char *b;
+      cfb_next(ctx, pos);
+      b= ctx->block + TREYFER_MOD(pos, TREYFER_512_OCTETS);
+      *d++= *b^= *s++;
+      if (++pos == CFB_SEGMENT_OCTETS) pos= 0;
+   }
+   ctx->pos= pos;
+}
+
+void simpenc_treyfer_cfb_decrypt(
+   struct simpenc_treyfer_cfb *ctx, void *dst, void const *src
+   , size_t octets
+) {
+   unsigned char *d= dst;
+   unsigned char const *s= src;
+   unsigned pos= ctx->pos;
+   while (octets--) {
+      unsigned char *b, c;
+      cfb_next(ctx, pos);
+      b= ctx->block + TREYFER_MOD(pos, TREYFER_512_OCTETS);
+      c= *s++; *d++= *b ^ c; *b= c;
+      if (++pos == CFB_SEGMENT_OCTETS) pos= 0;
+   }
+   ctx->pos= pos;
+}
+
+void simpenc_treyfer_cfb_init_at(
+   struct simpenc_treyfer_cfb *ctx, unsigned char const *key
+   , unsigned char const *prev, uint64_t offset
+) {
+   assert(offset && offset % SIMPENC_TREYFER_CFB_OCTETS == 0);
+   (void)memcpy(ctx->key, key, sizeof ctx->key);
+   /* cfb_next() encrypts <prev> before it is used, unless <offset> starts
+    * a segment. */
+   (void)memcpy(ctx->block, prev, sizeof ctx->block);
+   ctx->pos= (unsigned)(offset % CFB_SEGMENT_OCTETS);
+}
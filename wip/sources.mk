@@ -1,5 +1,7 @@
 SOURCES = \
+	kernel-bench.c \
 	rc4sxs-crypt.c \
+	simpenc-split.c \
 	treyfer-cfb-512.c \
 	treyfer-hash.c \
 	treyfer-ofb.c \
@@ -0,0 +1,162 @@
+/*
+ * Run-time statistics for shared use in different applications.
+ *
+ * Enabled by setting the environment variable SIMPENC_STATS to anything
+ * but an empty string or "0", or by the application calling
+ * stats_enable() for a command line option. When enabled, a single line
+ * is written to standard error when the program exits:
+ *
+ * simpenc-stats tool=<name> wall_s=<seconds> cpu_s=<seconds>
+ * bytes_in=<octets> bytes_out=<octets> reads=<calls> writes=<calls>
+ * [io_wall_s=<seconds>] mb_s=<MB/s> <phase>_wall_s=<seconds>
+ * <phase>_cpu_s=<seconds> ...
+ *
+ * all on the same line. The application divides its run time into named
+ * phases with stats_phase(); the first phase is always "setup". cpu_s
+ * includes all threads of the process. mb_s is the larger of bytes_in and
+ * bytes_out divided by wall_s. io_wall_s is the time spent in the read
+ * and write calls and is only present if the application measures it.
+ *
+ * The I/O counters are always updated, which is cheaper than checking
+ * whether statistics are enabled. They must only be updated by a single
+ * thread.
+ *
+ * Requires _POSIX_C_SOURCE 199309L or later for clock_gettime().
+ *
+ * Version 2026.290
+ *
+ * Copyright (c) 2026 Guenther Brunthaler. All rights reserved.
+ *
+ * This source file is free software.
+ * Distribution is permitted under the terms of the GPLv3.
+ */
+
+#include <dim_sdbrke8ae851uitgzm4nv3ea2.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+
+#define STATS_ENV "SIMPENC_STATS"
+
+static struct {
+   char const *tool;
+   int enabled;
+   unsigned phases, current;
+   struct {
+      char const *name;
+      uint64_t wall, cpu;
+   } phase[8];
+   uint64_t wall0, cpu0; /* Start of the current phase. */
+   uint64_t bytes_in, bytes_out, reads, writes, io_wall, io_timed;
+} stats;
+
+static inline uint64_t stats_clock(clockid_t clock) {
+   struct timespec ts;
+   if (clock_gettime(clock, &ts)) return 0;
+   return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/* Add the time since the start of the current phase to it. */
+static inline void stats_close_phase(void) {
+   uint64_t wall= stats_clock(CLOCK_MONOTONIC);
+   uint64_t cpu= stats_clock(CLOCK_PROCESS_CPUTIME_ID);
+   stats.phase[stats.current].wall+= wall - stats.wall0;
+   stats.phase[stats.current].cpu+= cpu - stats.cpu0;
+   stats.wall0= wall; stats.cpu0= cpu;
+}
+
+static void stats_report(void) {
+   uint64_t wall= 0, cpu= 0, bytes;
+   unsigned i;
+   stats_close_phase();
+   for (i= 0; i < stats.phases; ++i) {
+      wall+= stats.phase[i].wall; cpu+= stats.phase[i].cpu;
+   }
+   bytes= stats.bytes_in > stats.bytes_out ? stats.bytes_in : stats.bytes_out;
+   (void)fprintf(
+      stderr
+      , "simpenc-stats tool=%s wall_s=%.6f cpu_s=%.6f bytes_in=%" PRIu64
+        " bytes_out=%" PRIu64 " reads=%" PRIu64 " writes=%" PRIu64
+      , stats.tool, wall / 1e9, cpu / 1e9
+      , stats.bytes_in, stats.bytes_out, stats.reads, stats.writes
+   );
+   if (stats.io_timed) {
+      (void)fprintf(stderr, " io_wall_s=%.6f", stats.io_wall / 1e9);
+   }
+   (void)fprintf(stderr, " mb_s=%.3f", wall ? bytes * 1e3 / wall : 0.0);
+   for (i= 0; i < stats.phases; ++i) {
+      (void)fprintf(
+         stderr, " %s_wall_s=%.6f %s_cpu_s=%.6f"
+         , stats.phase[i].name, stats.phase[i].wall / 1e9
+         , stats.phase[i].name, stats.phase[i].cpu / 1e9
+      );
+   }
+   (void)fputc('\n', stderr);
+}
+
+/* Start the "setup" phase. Call this first thing in main(). */
+static inline void stats_init(char const *tool) {
+   char const *env= getenv(STATS_ENV);
+   stats.tool= tool;
+   stats.phase[0].name= "setup"; stats.phases= 1; stats.current= 0;
+   stats.wall0= stats_clock(CLOCK_MONOTONIC);
+   stats.cpu0= stats_clock(CLOCK_PROCESS_CPUTIME_ID);
+   if (env && *env && strcmp(env, "0")) {
+      stats.enabled= !atexit(stats_report);
+   }
+}
+
+/* Enable statistics regardless of the environment variable. */
+static inline void stats_enable(void) {
+   if (!stats.enabled) stats.enabled= !atexit(stats_report);
+}
+
+/* End the current phase and start the phase <name>, which must be a string
+ * literal. Starting a phase again adds to its previous times. The phases
+ * are reported in the order they have been started first. */
+static inline void stats_phase(char const *name) {
+   unsigned i;
+   if (!stats.enabled) return;
+   stats_close_phase();
+   for (i= 0; i < stats.phases; ++i) {
+      if (!strcmp(stats.phase[i].name, name)) { stats.current= i; return; }
+   }
+   if (stats.phases == DIM(stats.phase)) return; /* Keep the current one. */
+   stats.phase[i].name= name; stats.phase[i].wall= stats.phase[i].cpu= 0;
+   stats.current= stats.phases++;
+}
+
+/* Returns the start time for stats_read() or stats_write(), or 0 if the
+ * I/O time is not measured. */
+static inline uint64_t stats_io_begin(void) {
+   return stats.enabled ? stats_clock(CLOCK_MONOTONIC) : 0;
+}
+
+static inline void stats_io_end(uint64_t t0) {
+   if (t0) {
+      stats.io_wall+= stats_clock(CLOCK_MONOTONIC) - t0;
+      ++stats.io_timed;
+   }
+}
+
+/* Account for a read call which returned <n> octets and started at <t0>
+ * as returned by stats_io_begin(). Pass 0 for <t0> if the duration has
+ * not been measured. */
+static inline void stats_read(size_t n, uint64_t t0) {
+   ++stats.reads; stats.bytes_in+= n; stats_io_end(t0);
+}
+
+/* Account for <calls> read calls which returned <n> octets in total and
+ * have been counted elsewhere, such as by a thread which must not update
+ * the counters itself. */
+static inline void stats_reads(uint64_t calls, uint64_t n) {
+   stats.reads+= calls; stats.bytes_in+= n;
+}
+
+/* Like stats_read() for a write call of <n> octets. */
+static inline void stats_write(size_t n, uint64_t t0) {
+   ++stats.writes; stats.bytes_out+= n; stats_io_end(t0);
+}
@@ -1,8 +1,12 @@
+kernel-bench: kernel-bench.o $(LIBS)
+	$(CC) $(LDFLAGS) -o $@ kernel-bench.o $(LIBS) $(LDLIBS)
 rc4sxs-crypt: rc4sxs-crypt.o $(LIBS)
-	$(CC) $(LDFLAGS) -o $@ rc4sxs-crypt.o $(LIBS)
+	$(CC) $(LDFLAGS) -o $@ rc4sxs-crypt.o $(LIBS) $(LDLIBS)
+simpenc-split: simpenc-split.o $(LIBS)
+	$(CC) $(LDFLAGS) -o $@ simpenc-split.o $(LIBS) $(LDLIBS)
 treyfer-cfb-512: treyfer-cfb-512.o $(LIBS)
-	$(CC) $(LDFLAGS) -o $@ treyfer-cfb-512.o $(LIBS)
+	$(CC) $(LDFLAGS) -o $@ treyfer-cfb-512.o $(LIBS) $(LDLIBS)
 treyfer-hash: treyfer-hash.o $(LIBS)
-	$(CC) $(LDFLAGS) -o $@ treyfer-hash.o $(LIBS)
+	$(CC) $(LDFLAGS) -o $@ treyfer-hash.o $(LIBS) $(LDLIBS)
 treyfer-ofb: treyfer-ofb.o $(LIBS)
-	$(CC) $(LDFLAGS) -o $@ treyfer-ofb.o $(LIBS)
+	$(CC) $(LDFLAGS) -o $@ treyfer-ofb.o $(LIBS) $(LDLIBS)
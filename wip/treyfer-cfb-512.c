@@ -1,5 +1,5 @@
-#define VERSTR "Version 2022.67"
-#define COPYRIGHT_NOTICE "Copyright (c) 2021-2022 Guenther Brunthaler."
+#define VERSTR "Version 2026.290"
+#define COPYRIGHT_NOTICE "Copyright (c) 2021-2026 Guenther Brunthaler."
 
 static char help[]= { /* Formatted as 66 output columns. */
    "treyfer-cfb-512 - Encrypt or decrypt binary data with a 512 bit\n"
@@ -8,8 +8,24 @@ static char help[]= { /* Formatted as 66 output columns. */
    "In both cases a binary 64-byte long-term key is read from standard\n"
    "input first. Then a 64-byte initialization vector (IV) is read,\n"
    "followed by the data to be encrypted or decrypted. The result will\n"
-   "be written to standard output. Command line arguments are not\n"
-   "used.\n"
+   "be written to standard output.\n"
+   "\n"
+   "Usage: treyfer-cfb-512 [ <options> ]\n"
+   "\n"
+   "-d: Decrypt. Without this option, the program encrypts.\n"
+   "\n"
+   "-j <threads>: Decrypt with <threads> threads. In CFB mode, every\n"
+   "block of keystream only depends on the preceding block of\n"
+   "ciphertext, so different parts of the ciphertext can be decrypted\n"
+   "at the same time. Encryption cannot be parallelized this way.\n"
+   "Requires -d.\n"
+   "\n"
+   "-v: Write statistics about the duration of the phases of the\n"
+   "program and about its I/O to standard error when it exits.\n"
+   "Setting the environment variable SIMPENC_STATS to anything but an\n"
+   "empty string or \"0\" does the same.\n"
+   "\n"
+   "-h: Display this help and exit.\n"
    "\n"
    "The IV is arbitrary data and does not need to be kept secret, but\n"
    "the same IV must never be used for encrypting more than a single\n"
@@ -31,8 +47,8 @@ static char help[]= { /* Formatted as 66 output columns. */
    "from the digits of pi.\n"
    "\n"
    "This block cipher is then run in the CFB mode of operation,\n"
-   "turning it into a stream cipher which can be used for both\n"
-   "encryption and decryption and does not require any padding.\n"
+   "turning it into a stream cipher which does not require any\n"
+   "padding.\n"
    "\n"
    "" VERSTR "\n"
    "\n"
@@ -42,8 +58,12 @@ static char help[]= { /* Formatted as 66 output columns. */
    "Distribution is permitted under the terms of the GPLv3.\n"
 };
 
+#define _POSIX_C_SOURCE 200112L
 #include "config.h"
-#include "treyfer_sbox.h"
+#include <simpenc_12xa3exh75vq0l98qouxald4m.h>
+#include <getopt_nh7lll77vb62ycgwzwf30zlln.h>
+#include "stats_common.h"
+#include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <limits.h>
@@ -51,34 +71,146 @@ static char help[]= { /* Formatted as 66 output columns. */
 
 #define BUFFER_SIZE (64 * 1024)
 
+/* Octets of ciphertext decrypted by every thread for -j at once, and the
+ * upper limit for -j. The I/O buffer has room for one piece per thread. */
+#define PIECE_OCTETS (1024 * 1024)
+#define THREADS_MAX 256
+
 #define DIM(array) (sizeof(array) / sizeof *(array))
 
+/* A part of the I/O buffer which is decrypted by a thread of its own. */
+struct piece {
+   struct simpenc_treyfer_cfb cfb;
+   unsigned char *data;
+   size_t octets;
+   pthread_t tid;
+};
+
+static void *decrypt_piece(void *piece) {
+   struct piece *p= piece;
+   simpenc_treyfer_cfb_decrypt(&p->cfb, p->data, p->data, p->octets);
+   return 0;
+}
+
+/* Decrypt <octets> of ciphertext at <data> in place, which follows
+ * <offset> octets of ciphertext which have already been decrypted with
+ * <cfb>, and advance <cfb> beyond them. Every piece of PIECE_OCTETS is
+ * decrypted by a thread of its own, using the structures in <pieces>.
+ * Returns 0 on success. */
+static int decrypt_parallel(
+   struct simpenc_treyfer_cfb *cfb, unsigned char const *key
+   , unsigned char *data, size_t octets, uint64_t offset
+   , struct piece *pieces
+) {
+   unsigned i, n= (unsigned)((octets + PIECE_OCTETS - 1) / PIECE_OCTETS);
+   int rc= 0;
+   assert(PIECE_OCTETS % SIMPENC_TREYFER_CFB_OCTETS == 0);
+   /* Set up all pieces before any of them is decrypted in place, because
+    * each one needs the last ciphertext block of its predecessor. */
+   for (i= 0; i < n; ++i) {
+      pieces[i].data= data + (size_t)i * PIECE_OCTETS;
+      pieces[i].octets=
+         i + 1 < n ? PIECE_OCTETS : octets - (size_t)i * PIECE_OCTETS
+      ;
+      if (i) {
+         simpenc_treyfer_cfb_init_at(
+            &pieces[i].cfb, key
+            , pieces[i].data - SIMPENC_TREYFER_CFB_OCTETS
+            , offset + (uint64_t)i * PIECE_OCTETS
+         );
+      } else {
+         pieces[i].cfb= *cfb;
+      }
+   }
+   for (i= 1; i < n; ++i) {
+      if (pthread_create(&pieces[i].tid, 0, decrypt_piece, &pieces[i])) {
+         rc= -1; break;
+      }
+   }
+   (void)decrypt_piece(&pieces[0]);
+   while (--i) (void)pthread_join(pieces[i].tid, 0);
+   *cfb= pieces[n - 1].cfb;
+   return rc;
+}
+
 int main(int argc, char **argv) {
-   unsigned char key[512 / 8], block[512 / 8], *buffer, *dst;
-   int eof_allowed;
-   unsigned base, left, bytes_read;
+   unsigned char key[512 / 8], block[512 / 8], *buffer= 0, *dst= 0;
+   static struct simpenc_treyfer_cfb cfb;
+   struct piece *pieces= 0;
+   int eof_allowed= 0, decrypt= 0;
+   unsigned bytes_read= 0, threads= 1, buffer_size= BUFFER_SIZE;
+   uint64_t offset= 0; /* Of <buffer> within the data after the IV. */
    char const *error;
    enum {
          initial, release, die, read_key, read_something, read_iv, init_cfb
-      ,  encrypt_block, read_buffer, cfb_buffer, cfb_segment, finished
+      ,  read_buffer, cfb_buffer, finished
    } state= initial, followup_state;
-   (void)argv;
-   if (argc > 1) {
-      if (fputs(help, stdout) < 0) goto raise_write_error;
-      state= finished;
+   stats_init("treyfer-cfb-512");
+   {
+      int a= 0, optpos= 0;
+      for (;;) {
+         int opt;
+         switch (opt= getopt_simplest(&a, &optpos, argc, argv)) {
+            case 0: goto no_more_options;
+            case 'd': decrypt= 1; break;
+            case 'j':
+               {
+                  char const *arg;
+                  long n;
+                  if (!(arg= getopt_simplest_mand_arg(
+                     &a, &optpos, argc, argv
+                  ))) {
+                     getopt_simplest_perror_missing_arg(opt);
+                     return EXIT_FAILURE;
+                  }
+                  if ((n= atol(arg)) < 1 || n > THREADS_MAX) {
+                     error= "Invalid number of threads!";
+                     state= die; goto complain;
+                  }
+                  threads= (unsigned)n;
+               }
+               break;
+            case 'v': stats_enable(); break;
+            case 'h': state= finished; goto no_more_options;
+            default:
+               getopt_simplest_perror_opt(opt); return EXIT_FAILURE;
+         }
+      }
+      no_more_options:
+      if (state == finished) {
+         if (fputs(help, stdout) < 0) goto raise_write_error;
+      } else if (a < argc) {
+         error= "Command line arguments other than options are not used!";
+         state= die; goto complain;
+      } else if (threads > 1) {
+         if (!decrypt) {
+            error= "-j requires -d!";
+            state= die; goto complain;
+         }
+         buffer_size= threads * PIECE_OCTETS;
+      }
    }
    for (;;) {
       switch (state) {
          case initial: /* Allocate the I/O buffer. */
-            if (buffer= malloc(BUFFER_SIZE)) { state= read_key; break; }
+            if (
+               (buffer= malloc(buffer_size))
+               && (
+                  threads == 1
+                  || (pieces= malloc(threads * sizeof *pieces))
+               )
+            ) {
+               state= read_key; break;
+            }
             error= "Out of memory!";
             fail:
+            followup_state= die; state= release;
+            complain:
             (void)fputs(error, stderr);
             (void)fputc('\n', stderr);
-            followup_state= die; /* state= release; */
-            /* Fall through. */
-         case release: /* Free the I/O buffer. */
-            free(buffer); /* Won't hurt even if the buffer is null. */
+            break;
+         case release: /* Free the I/O buffers. */
+            free(pieces); free(buffer); /* Won't hurt even if null. */
             state= followup_state;
             break;
          case die: /* Terminate due to failure. */
@@ -90,10 +222,10 @@ int main(int argc, char **argv) {
          case read_something: /* Read from standard input. */
             {
                size_t read;
-               if (
-                  (read= fread(dst, sizeof *dst, bytes_read, stdin))
-                  != bytes_read
-               ) {
+               uint64_t t0= stats_io_begin();
+               read= fread(dst, sizeof *dst, bytes_read, stdin);
+               stats_read(read, t0);
+               if (read != bytes_read) {
                   if (ferror(stdin)) { error= "Read error!"; goto fail; }
                   assert(feof(stdin));
                   if (!eof_allowed) {
@@ -112,83 +244,49 @@ int main(int argc, char **argv) {
             followup_state= init_cfb; state= read_something;
             break;
          case init_cfb: /* Initialize CFB by encrypting the IV. */
+            stats_phase("bulk");
+            assert(DIM(block) == SIMPENC_TREYFER_CFB_OCTETS);
+            assert(DIM(key) == SIMPENC_TREYFER_CFB_OCTETS);
+            simpenc_treyfer_cfb_init(&cfb, key, block);
             eof_allowed= 1; /* Will stay like this from now on. */
-            followup_state= read_buffer; /* state= encrypt_block; */
+            /* state= read_buffer; */
             /* Fall through. */
-         case encrypt_block: /* Encrypt the block[] with Treyfer. */
-            #define MOD(x, m) ((unsigned char)(x) & (unsigned char)((m) - 1))
-            #define MOD_A(x, array) MOD(x, DIM(array))
-            #define ORIGINAL_BLOCK_BITS 64
-            #define ORIGINAL_ROUNDS 32
-            #define FACTOR_BIGGER 8
-            #define NUMROUNDS (ORIGINAL_ROUNDS * FACTOR_BIGGER)
-            assert(ORIGINAL_BLOCK_BITS * FACTOR_BIGGER == DIM(block) * 8);
-            {
-               unsigned i= 0;
-               unsigned char t= block[0];
-               for (i= 0; i < ORIGINAL_BLOCK_BITS / 8 * NUMROUNDS; ) {
-                  /* This is the core of the Treyfer algorithm. */
-                  t= t + key[MOD_A(i, key)] & 0xff;
-                  assert(t < DIM(sbox));
-                  ++i; t= MOD_A(sbox[t] + block[MOD_A(i, block)], sbox);
-                  /* ROT-L by 1 bit. */
-                  block[MOD_A(i, block)]= t= (unsigned char)(
-                     t + t & 0xff | t >> CHAR_BIT - 1
-                  );
-               }
-            }
-            #undef NUMROUNDS
-            #undef FACTOR_BIGGER
-            #undef ORIGINAL_ROUNDS
-            #undef ORIGINAL_BLOCK_BITS
-            #undef MOD_A
-            #undef MOD
-            state= followup_state;
-            break;
          case read_buffer:
             /* Main loop. Try to read the next buffer of input. */
-            dst= buffer; bytes_read= BUFFER_SIZE;
+            dst= buffer; bytes_read= buffer_size;
             assert(eof_allowed);
             followup_state= cfb_buffer; state= read_something;
             break;
-         case cfb_buffer: /* CFB-encrypt the next buffer, unless empty. */
+         case cfb_buffer: /* CFB-process the next buffer, unless empty. */
             if (!bytes_read) {
                /* EOF. */
                followup_state= finished; state= release;
                break;
             }
-            base= 0; /* state= cfb_segment; */
-            /* Fall through. */
-         case cfb_segment: /* CFB-encrypt next buffer segment. */
-            assert(base < bytes_read);
-            if ((left= bytes_read - base) > DIM(block)) {
-               left= (unsigned)DIM(block);
-               assert(left == DIM(block));
+            if (!decrypt) {
+               simpenc_treyfer_cfb_encrypt(&cfb, buffer, buffer, bytes_read);
+            } else if (threads == 1) {
+               simpenc_treyfer_cfb_decrypt(&cfb, buffer, buffer, bytes_read);
+            } else if (
+               decrypt_parallel(
+                  &cfb, key, buffer, bytes_read, offset, pieces
+               )
+            ) {
+               error= "Could not create thread!"; goto fail;
             }
-            assert(left >= 1);
-            /* XOR current buffer segment with encrypted last block.
-             * Then replace the block contents with the updated segment. */
+            offset+= bytes_read;
+            /* Output the buffer. */
             {
-               unsigned i;
-               for (i= 0; left--; ++i) {
-                  block[i]= buffer[base++]^= block[i];
+               uint64_t t0= stats_io_begin();
+               if (
+                  fwrite(buffer, sizeof *buffer, bytes_read, stdout)
+                  != bytes_read
+               ) {
+                  assert(ferror(stdout));
+                  raise_write_error:
+                  error= "Write error!"; goto fail;
                }
-            }
-            if (base != bytes_read) {
-               assert(base < bytes_read);
-               /* Encrypt the block just queued for output later in
-                * order to prepare for next CFB segment. Then process
-                * next segment. */
-               followup_state= cfb_segment; state= encrypt_block;
-               break;
-            }
-            /* Processing of buffer is complete. Output the buffer. */
-            if (
-               fwrite(buffer, sizeof *buffer, bytes_read, stdout) != bytes_read
-            ) {
-               assert(ferror(stdout));
-               raise_write_error:
-               error= "Write error!"; goto fail;
+               stats_write(bytes_read, t0);
             }
             state= read_buffer; /* Advance to the next buffer load. */
             break;
@@ -1,5 +1,5 @@
-#define VERSTR_1 "Version 2022.68"
-#define VERSTR_2 "Copyright (c) 2021-2022 Guenther Brunthaler."
+#define VERSTR_1 "Version 2026.290"
+#define VERSTR_2 "Copyright (c) 2021-2026 Guenther Brunthaler."
 
 static char help[]= { /* Formatted as 66 output columns. */
    "treyfer-hash - abuse treyfer-MAC for hashing or for key\n"
@@ -64,6 +64,68 @@ static char help[]= { /* Formatted as 66 output columns. */
    "characters as the hash. Output stops when <chars> characters\n"
    "have been written as the digest representation.\n"
    "\n"
+   "-j <threads>: Hash up to <threads> files at the same time, using\n"
+   "that many threads. The digests are written in the same order as\n"
+   "without -j. The default is '-j 1'.\n"
+   "\n"
+   "-f: Read the pathnames of the files to hash from standard input,\n"
+   "one per line, instead of taking them from the command line. Empty\n"
+   "lines are ignored.\n"
+   "\n"
+   "-0: Like -f, but the pathnames are terminated by null characters\n"
+   "instead of newlines, as written by 'find -print0'.\n"
+   "\n"
+   "-C <manifest>: Verify the files listed in <manifest>, which has\n"
+   "the format of the output of this program without -r. For every\n"
+   "file, '<pathname>: OK' or '<pathname>: FAILED' is written, and\n"
+   "the program fails if any file could not be verified or any line\n"
+   "is not formatted properly. The digest size is taken from every\n"
+   "line, but -x, -t and -T must be the same as for creating\n"
+   "<manifest>. Combine with -j to verify several files at the same\n"
+   "time.\n"
+   "\n"
+   "-K <cache>: Skip the files listed by -C which have not changed\n"
+   "since they have last been verified successfully. The file <cache>\n"
+   "records the device, inode, size and modification time of those\n"
+   "files together with their digests. It is created if it does not\n"
+   "exist yet, and is replaced by the files verified successfully\n"
+   "after every run, so use a separate cache for every manifest.\n"
+   "\n"
+   "-t: Hash with the Treyfer-512 compression function as described\n"
+   "above. Without -t, the input is used as the key of an ARCFOUR\n"
+   "instance with the key schedule of rc4sxs-crypt instead, and the\n"
+   "digest is its output after dropping the first 3072 octets. This\n"
+   "has been the only engine of earlier versions, and it is still the\n"
+   "default because it is faster and because its digests must stay\n"
+   "the same. The engines produce different digests. -S and -R cannot\n"
+   "be combined with -t.\n"
+   "\n"
+   "-T: Tree mode for huge files. The input is cut into leaves of 1\n"
+   "MiB, which are hashed separately, and the digest is the hash of\n"
+   "the digests of all leaves and the size of the input. With -j,\n"
+   "the leaves of a regular file are hashed in parallel, but files\n"
+   "are still hashed one after another. The digests are different\n"
+   "from those without -T and are written with the prefix 'tree:'\n"
+   "unless -r is specified. Can be combined with -t, but not with -S\n"
+   "or -R.\n"
+   "\n"
+   "-S <checkpoint>: Save the state of the hash calculation after\n"
+   "all input has been processed to the file <checkpoint>.\n"
+   "\n"
+   "-R <checkpoint>: Resume the hash calculation from a file written\n"
+   "by -S. The input must start with the same octets as the input\n"
+   "from which the checkpoint has been saved. Those octets are\n"
+   "skipped, by seeking past them if the input is a regular file, and\n"
+   "only the remaining input will be processed. This allows to update\n"
+   "the hash of a growing log file quickly. Can be combined with -S\n"
+   "for updating the same checkpoint. -S and -R require that at most\n"
+   "one file is hashed.\n"
+   "\n"
+   "-v: Write statistics about the duration of the phases of the\n"
+   "program and about its I/O to standard error when it exits.\n"
+   "Setting the environment variable SIMPENC_STATS to anything but an\n"
+   "empty string or \"0\" does the same.\n"
+   "\n"
    "-h: Display this help and exit.\n"
    "\n"
    "-V: Display version information and exit.\n"
@@ -109,13 +171,39 @@ static char version_info[]= {
    "Distribution is permitted under the terms of the GPLv3."
 };
 
+#define _POSIX_C_SOURCE 200809L
+#include "config.h"
 #include <dim_sdbrke8ae851uitgzm4nv3ea2.h>
 #include <getopt_nh7lll77vb62ycgwzwf30zlln.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <limits.h>
 #include <assert.h>
+#include <simpenc_12xa3exh75vq0l98qouxald4m.h>
 #include "arc4_common.h"
+#include "arc4_checkpoint.h"
+#include "stats_common.h"
+
+/* Octets read from the input at once. A multiple of the Treyfer block
+ * size, so that the Treyfer engine buffers nothing between reads. */
+#define IOBUF_OCTETS (64 * 1024)
+
+/* Octets of digest generated at once for encoding. */
+#define DIGEST_CHUNK 256
+
+/* Upper limit for -j. */
+#define THREADS_MAX 1024
+
+/* Jobs which can be queued or finished but not yet written for every
+ * worker thread. */
+#define JOBS_PER_THREAD 4
 
 static char const b32custom_alphabet[]= {
    /*
@@ -134,37 +222,599 @@ static char const hex_alphabet[]= {
    ,  '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
 };
 
-#include "treyfer_sbox.h"
+/* Options which apply to every input. */
+static char const *save_fname, *resume_fname;
+static int treyfer, tree;
+static unsigned long digest_chars;
+static char const *alphabet= b32custom_alphabet;
+static unsigned alphabet_bitmask= (unsigned)DIM(b32custom_alphabet) - 1;
+static unsigned alphabet_bits;
+
+/* The inputs to hash: Standard input itself if <hash_stdin> is set, else
+ * the files named by the remaining <args_left> command line arguments at
+ * <args>, or by the list read from <list_fh> if <list_delim> is not EOF.
+ * The list is either standard input or the manifest for -C. */
+static int hash_stdin;
+static char **args;
+static int args_left, list_delim= EOF;
+static FILE *list_fh;
+
+/* Verification (-C) of the files listed in the manifest, with the stat
+ * cache (-K) if <cache_fname> is set. */
+static char const *manifest_fname, *cache_fname;
+static unsigned long mismatched, unreadable, bad_lines;
+
+/* The libsimpenc flags for the hash of an input, or of a leaf of it if
+ * <leaf> is set. */
+static unsigned hash_flags(int leaf) {
+   return
+      (treyfer ? SIMPENC_HASH_TREYFER : 0)
+      | (tree && !leaf ? SIMPENC_HASH_TREE : 0)
+   ;
+}
+
+/* End the message. <serial> as for hash_job(). */
+static void hash_end(struct simpenc_hash *h, int serial) {
+   if (serial) stats_phase(treyfer ? "final" : "drop");
+   simpenc_hash_end(h);
+}
+
+/* Tree mode (-T): The input is cut into leaves of SIMPENC_HASH_LEAF_OCTETS
+ * which are hashed separately as described in the libsimpenc header, and
+ * the digest is the hash of their digests and the size of the input. */
+#define LEAF_OCTETS SIMPENC_HASH_LEAF_OCTETS
+
+/* Precedes the digests of tree mode unless they are written as raw
+ * octets, so that they cannot be mistaken for the hash of the input. */
+#define TREE_LABEL "tree:"
+
+/* The hashing of a single input, from opening it to the point where its
+ * digest can be squeezed out of <h>. In tree mode, the hashing of a
+ * single leaf of the input is a job of its own if the leaves are hashed
+ * in parallel, and <fd> is the file descriptor to read it from at
+ * <offset>. Otherwise <fd> is -1. */
+struct job {
+   char const *name; /* Null for standard input. */
+   char *alloc; /* To be freed after the job, or null. */
+   /* Why the job failed, and the pathname to report with it, if any. */
+   char const *error, *error_arg;
+   struct simpenc_hash h;
+   int fd;
+   off_t offset;
+   uint64_t reads, bytes_in;
+   int done; /* Protected by <pool.lock>. */
+   /* With -C, the digest expected by the manifest. <st> is valid if
+    * <statted> is set, and <cached> means that the file need not be
+    * hashed because it has not changed since it has been verified. */
+   char const *digest;
+   struct stat st;
+   int statted, cached;
+};
+
+/* An entry of the stat cache. The cache file has a line
+ *
+ * <dev> <ino> <size> <mtime_ns> <engine> <digest>
+ *
+ * for every file which has been verified, with the numbers in decimal and
+ * <digest> as in the manifest. */
+struct cache_entry {
+   uintmax_t dev, ino, size, mtime_ns;
+   char *digest;
+};
+
+/* The entries loaded from the cache file, sorted by device and inode, and
+ * the entries of the files verified by this run, which replace them. */
+static struct cache {
+   struct cache_entry *entry;
+   size_t entries, size;
+} old_cache, new_cache;
+
+static char const *engine_name(void) {
+   return treyfer ? "treyfer" : "arcfour";
+}
 
-static void treyfer_compress(
-   unsigned char (*digest)[64], unsigned char (*block)[64]
+static void cache_key(struct cache_entry *e, struct stat const *st) {
+   e->dev= (uintmax_t)st->st_dev; e->ino= (uintmax_t)st->st_ino;
+   e->size= (uintmax_t)st->st_size;
+   e->mtime_ns=
+      (uintmax_t)st->st_mtim.tv_sec * 1000000000
+      + (uintmax_t)st->st_mtim.tv_nsec
+   ;
+}
+
+static int cache_cmp(void const *a, void const *b) {
+   struct cache_entry const *x= a, *y= b;
+   if (x->dev != y->dev) return x->dev < y->dev ? -1 : 1;
+   if (x->ino != y->ino) return x->ino < y->ino ? -1 : 1;
+   return 0;
+}
+
+/* Add a copy of <e> with <digest> to <cache>. Returns 0 on success. */
+static int cache_add(
+   struct cache *cache, struct cache_entry const *e, char const *digest
 ) {
-   unsigned i;
-   {
-      #define MOD(x, m) ((unsigned char)(x) & (unsigned char)((m) - 1))
-      #define MOD_A(x, array) MOD(x, DIM(array))
-      #define NUMROUNDS (32 * 8)
-      unsigned char t= **digest;
-      for (i= 0; i < CHAR_BIT * NUMROUNDS; ) {
-         t= MOD_A(sbox[t] + (*digest)[i= MOD_A(i + 1, *digest)], sbox);
-         /* ROT-L by 1 bit. */
-         (*digest)[i]= t= t << 1 | t >> CHAR_BIT - 1;
+   struct cache_entry *n;
+   size_t len= strlen(digest) + 1;
+   if (cache->entries == cache->size) {
+      size_t size= cache->size ? cache->size + cache->size : 64;
+      if (!(n= realloc(cache->entry, size * sizeof *n))) return -1;
+      cache->entry= n; cache->size= size;
+   }
+   n= &cache->entry[cache->entries];
+   *n= *e;
+   if (!(n->digest= malloc(len))) return -1;
+   (void)memcpy(n->digest, digest, len);
+   ++cache->entries;
+   return 0;
+}
+
+/* Load <old_cache> from the file <cache_fname>, which need not exist yet.
+ * Lines for the other engine or in an unknown format are ignored; those
+ * files are just verified again. Returns 0 on success, -1 if the file
+ * could not be read and 1 if out of memory. */
+static int cache_load(void) {
+   FILE *fh;
+   char *line= 0;
+   size_t size= 0, len= strlen(engine_name());
+   int rc= 0;
+   if (!(fh= fopen(cache_fname, "r"))) return errno == ENOENT ? 0 : -1;
+   while (getline(&line, &size, fh) >= 0) {
+      struct cache_entry e;
+      uintmax_t *field[4];
+      char *p= line, *end;
+      unsigned k;
+      field[0]= &e.dev; field[1]= &e.ino;
+      field[2]= &e.size; field[3]= &e.mtime_ns;
+      for (k= 0; k < DIM(field); ++k) {
+         if (*p < '0' || *p > '9') goto next;
+         *field[k]= strtoumax(p, &end, 10);
+         if (*end != ' ') goto next;
+         p= end + 1;
+      }
+      if (strncmp(p, engine_name(), len) || p[len] != ' ') goto next;
+      p+= len + 1;
+      if (end= strchr(p, '\n')) *end= '\0';
+      if (!*p) goto next;
+      if (cache_add(&old_cache, &e, p)) { rc= 1; break; }
+      next:;
+   }
+   if (!rc && ferror(fh)) rc= -1;
+   free(line);
+   (void)fclose(fh);
+   if (old_cache.entries) {
+      qsort(
+         old_cache.entry, old_cache.entries, sizeof *old_cache.entry
+         , cache_cmp
+      );
+   }
+   return rc;
+}
+
+/* Replace the file <cache_fname> by <new_cache>. Returns 0 on success. */
+static int cache_save(void) {
+   static char const suffix[]= ".new";
+   char *tmp;
+   FILE *fh;
+   size_t i;
+   int rc= -1;
+   if (!(tmp= malloc(strlen(cache_fname) + sizeof suffix))) return -1;
+   (void)strcpy(tmp, cache_fname); (void)strcat(tmp, suffix);
+   if (!(fh= fopen(tmp, "w"))) goto done;
+   for (i= 0; i < new_cache.entries; ++i) {
+      struct cache_entry const *e= &new_cache.entry[i];
+      if (
+         fprintf(
+            fh, "%" PRIuMAX " %" PRIuMAX " %" PRIuMAX " %" PRIuMAX " %s %s\n"
+            , e->dev, e->ino, e->size, e->mtime_ns, engine_name(), e->digest
+         ) < 0
+      ) {
+         break;
+      }
+   }
+   if (fclose(fh) || i < new_cache.entries || rename(tmp, cache_fname)) {
+      (void)remove(tmp);
+   } else {
+      rc= 0;
+   }
+   done:
+   free(tmp);
+   return rc;
+}
+
+/* Find out whether the file of <job> is in <old_cache> with the digest
+ * expected by the manifest and has not been changed since. */
+static void cache_probe(struct job *job) {
+   struct cache_entry key, *e;
+   if (stat(job->name, &job->st)) return;
+   job->statted= 1;
+   cache_key(&key, &job->st);
+   if (
+      old_cache.entries
+      && (e= bsearch(
+         &key, old_cache.entry, old_cache.entries, sizeof *e, cache_cmp
+      ))
+      && e->size == key.size && e->mtime_ns == key.mtime_ns
+      && !strcmp(e->digest, job->digest)
+   ) {
+      job->cached= 1;
+   }
+}
+
+/* Ring of <slots> jobs for the worker threads. <queued>, <taken> and
+ * <written> are free-running counters of the jobs which have been queued
+ * by the main thread, taken by a worker thread and used up by the main
+ * thread, in this order. Only the main thread changes <queued>, <written>
+ * and <closed>, so it may read them without locking. */
+static struct {
+   pthread_mutex_t lock;
+   pthread_cond_t work, done;
+   struct job *slot;
+   unsigned long queued, taken, written;
+   unsigned slots;
+   int closed; /* No more jobs will be queued. */
+} pool= {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+
+static void clear_job(struct job *job) {
+   job->name= 0; job->alloc= 0; job->error= job->error_arg= 0;
+   job->fd= -1; job->reads= job->bytes_in= 0; job->done= 0;
+   job->digest= 0; job->statted= job->cached= 0;
+}
+
+/* Queue the job which has been set up in the next free slot of <pool>. */
+static void queue_job(void) {
+   (void)pthread_mutex_lock(&pool.lock);
+   ++pool.queued;
+   (void)pthread_cond_signal(&pool.work);
+   (void)pthread_mutex_unlock(&pool.lock);
+}
+
+/* Tell the worker threads to terminate when there are no more jobs. */
+static void close_pool(void) {
+   (void)pthread_mutex_lock(&pool.lock);
+   pool.closed= 1;
+   (void)pthread_cond_broadcast(&pool.work);
+   (void)pthread_mutex_unlock(&pool.lock);
+}
+
+/* Wait until the oldest job in <pool> has been finished, and return it.
+ * The caller must make sure that there is one. */
+static struct job *oldest_job(void) {
+   struct job *job;
+   assert(pool.written != pool.queued);
+   job= &pool.slot[pool.written++ % pool.slots];
+   (void)pthread_mutex_lock(&pool.lock);
+   while (!job->done) (void)pthread_cond_wait(&pool.done, &pool.lock);
+   (void)pthread_mutex_unlock(&pool.lock);
+   return job;
+}
+
+/* Split the manifest line in <job->alloc> into the expected digest and
+ * the pathname. Returns 0 if the line is not formatted properly. */
+static int parse_manifest_line(struct job *job) {
+   char *line= job->alloc, *sp;
+   size_t k, label= tree ? sizeof TREE_LABEL - 1 : 0;
+   if (!(sp= strchr(line, ' ')) || !sp[1]) return 0;
+   *sp= '\0';
+   if (strncmp(line, TREE_LABEL, label) || !line[label]) return 0;
+   for (k= label; line[k]; ++k) {
+      if (!memchr(alphabet, line[k], alphabet_bitmask + 1)) return 0;
+   }
+   job->digest= line; job->name= sp + 1;
+   return 1;
+}
+
+/* Set up <job> for the next input. Returns 1 if there is one, 0 if there
+ * are no more inputs and -1 if the list of pathnames could not be read. */
+static int next_job(struct job *job) {
+   clear_job(job);
+   if (hash_stdin) { hash_stdin= 0; return 1; }
+   if (list_delim == EOF) {
+      if (!args_left) return 0;
+      --args_left; job->name= *args++;
+      return 1;
+   }
+   for (;;) {
+      char *line= 0;
+      size_t size= 0;
+      ssize_t n;
+      if ((n= getdelim(&line, &size, list_delim, list_fh)) < 0) {
+         free(line);
+         return feof(list_fh) ? 0 : -1;
+      }
+      if (n && line[n - 1] == list_delim) line[--n]= '\0';
+      if (!n) { free(line); continue; } /* Ignore empty lines. */
+      job->name= job->alloc= line;
+      if (!manifest_fname) return 1;
+      if (parse_manifest_line(job)) {
+         if (cache_fname) cache_probe(job);
+         return 1;
+      }
+      free(line); job->alloc= 0;
+      ++bad_lines;
+   }
+}
+
+/* Hash the leaf job <job> using <iobuf> of IOBUF_OCTETS. */
+static void hash_leaf(struct job *job, unsigned char *iobuf) {
+   off_t pos= job->offset, end= job->offset + LEAF_OCTETS;
+   simpenc_hash_init(&job->h, hash_flags(1));
+   while (pos < end) {
+      ssize_t got;
+      ++job->reads;
+      if (
+         (got= pread(
+            job->fd, iobuf
+            , end - pos < IOBUF_OCTETS ? (size_t)(end - pos) : IOBUF_OCTETS
+            , pos
+         )) < 0
+      ) {
+         if (errno == EINTR) continue;
+         job->error= "Error reading"; job->error_arg= job->name;
+         return;
+      }
+      if (!got) break;
+      simpenc_hash_update(&job->h, iobuf, (size_t)got);
+      job->bytes_in+= (size_t)got; pos+= got;
+   }
+   /* The main thread adds the leaf to the root. */
+}
+
+/* Hash the regular file <fd> of <job> in tree mode with the leaves as
+ * jobs of the worker threads, starting at the current file offset.
+ * Returns 0 on success, or -1 if <fd> cannot be read that way. */
+static int hash_tree_parallel(struct job *job, int fd) {
+   struct stat st;
+   off_t start, next;
+   if (fstat(fd, &st) || !S_ISREG(st.st_mode)) return -1;
+   if ((start= lseek(fd, 0, SEEK_CUR)) < 0) return -1;
+   stats_phase("absorb");
+   simpenc_hash_init(&job->h, hash_flags(0));
+   next= start;
+   do {
+      struct job *leaf;
+      /* Queue leaves as long as there are free slots. An empty input
+       * still has a single leaf. */
+      while (
+         (next < st.st_size || next == start)
+         && pool.queued - pool.written < pool.slots
+      ) {
+         leaf= &pool.slot[pool.queued % pool.slots];
+         clear_job(leaf);
+         leaf->name= job->name; leaf->fd= fd; leaf->offset= next;
+         next+= LEAF_OCTETS;
+         queue_job();
+      }
+      leaf= oldest_job();
+      stats_reads(leaf->reads, leaf->bytes_in);
+      if (leaf->error) {
+         job->error= leaf->error; job->error_arg= leaf->error_arg;
+         /* The leaves still queued read from <fd>, which the caller
+          * closes, and occupy slots of the pool. */
+         while (pool.written != pool.queued) {
+            leaf= oldest_job();
+            stats_reads(leaf->reads, leaf->bytes_in);
+         }
+         return 0;
+      }
+      simpenc_hash_add_leaf(&job->h, &leaf->h);
+   } while (pool.written != pool.queued);
+   hash_end(&job->h, 1);
+   return 0;
+}
+
+/* Run <job> using <iobuf> of IOBUF_OCTETS. <serial> means that no other
+ * thread is hashing on behalf of another job, so that the phases and the
+ * durations of the reads can be recorded in the statistics, and that the
+ * worker threads of <pool>, if any, may be used for the leaves in tree
+ * mode. The reads are only counted in <job>, though. */
+static void hash_job(struct job *job, unsigned char *iobuf, int serial) {
+   FILE *fh= stdin;
+   uint64_t absorbed= 0;
+   if (job->fd >= 0) { hash_leaf(job, iobuf); return; }
+   if (serial) stats_phase("absorb");
+   if (job->name && !(fh= fopen(job->name, "rb"))) {
+      job->error= "Could not open"; job->error_arg= job->name;
+      return;
+   }
+   if (tree && serial && pool.slots) {
+      if (!hash_tree_parallel(job, fileno(fh))) goto done;
+      /* Not a regular file. Hash it in a single thread. */
+   }
+   /* Process input as an (overly long) key to set. */
+   simpenc_hash_init(&job->h, hash_flags(0));
+   if (resume_fname) {
+      switch (arc4_checkpoint_load(resume_fname, job->h.h.r4, &absorbed)) {
+         case 0: break;
+         case 1: job->error= "Invalid checkpoint file"; goto ckpt_arg;
+         default:
+            job->error= "Could not read checkpoint file";
+            ckpt_arg:
+            job->error_arg= resume_fname;
+            goto done;
+      }
+      switch (arc4_checkpoint_skip(fh, absorbed)) {
+         case 0: break;
+         case 1:
+            job->error= "Checkpoint covers more than the whole input!";
+            goto done;
+         default: goto rderr;
+      }
+   }
+   for (;;) {
+      uint64_t t0= serial ? stats_io_begin() : 0;
+      size_t got= fread(iobuf, sizeof *iobuf, IOBUF_OCTETS, fh);
+      stats_io_end(t0);
+      ++job->reads; job->bytes_in+= got;
+      if (!got) break;
+      simpenc_hash_update(&job->h, iobuf, got);
+      absorbed+= got;
+   }
+   if (ferror(fh)) {
+      rderr:
+      if (job->name) {
+         job->error= "Error reading"; job->error_arg= job->name;
+      } else {
+         job->error= "Read error!";
+      }
+      goto done;
+   }
+   assert(feof(fh));
+   if (save_fname) {
+      if (arc4_checkpoint_save(save_fname, job->h.h.r4, absorbed)) {
+         job->error= "Could not write checkpoint file";
+         job->error_arg= save_fname;
+         goto done;
+      }
+   }
+   hash_end(&job->h, serial);
+   done:
+   if (job->name) (void)fclose(fh);
+}
+
+/* Turns the digest squeezed out of a finished job into characters of the
+ * output alphabet. Octets of the digest are generated in chunks. */
+struct encoder {
+   unsigned char raw[DIGEST_CHUNK];
+   size_t r;
+   unsigned buf, bufbits;
+};
+
+static void encode_init(struct encoder *enc) {
+   enc->r= DIM(enc->raw); enc->buf= enc->bufbits= 0;
+}
+
+/* Write the next <n> characters of the digest in <h> to <out>. */
+static void encode(
+   struct encoder *enc, struct simpenc_hash *h, unsigned char *out
+   , size_t n
+) {
+   while (n--) {
+      if (enc->bufbits < alphabet_bits) {
+         /* Append the bits of another digest octet to <buf>. */
+         if (enc->r == DIM(enc->raw)) {
+            simpenc_hash_squeeze(h, enc->raw, DIM(enc->raw));
+            enc->r= 0;
+         }
+         enc->buf= (enc->buf << 8 | enc->raw[enc->r++]) & 0xffff;
+         enc->bufbits+= 8;
+      }
+      assert(enc->bufbits >= alphabet_bits);
+      {
+         unsigned c=
+            enc->buf >> enc->bufbits - alphabet_bits & alphabet_bitmask
+         ;
+         if (alphabet) c= (unsigned)alphabet[c];
+         enc->bufbits-= alphabet_bits;
+         *out++= (unsigned char)c;
       }
-      #undef NUMROUNDS
-      #undef MOD_A
-      #undef MOD
    }
-   assert(DIM(*digest) == DIM(*block));
-   for (i= (unsigned)DIM(*block); i--; ) (*digest)[i]^= (*block)[i];
+}
+
+/* Write the digest of the finished <job>, followed by its pathname if it
+ * has one, to standard output. Returns 0 on success. */
+static int put_digest(struct job *job) {
+   /* The characters are collected in <out>. */
+   static unsigned char out[IOBUF_OCTETS];
+   struct encoder enc;
+   unsigned long k;
+   encode_init(&enc);
+   if (tree && alphabet) if (fputs(TREE_LABEL, stdout) < 0) return -1;
+   for (k= digest_chars; k; ) {
+      size_t n= k < DIM(out) ? (size_t)k : DIM(out);
+      encode(&enc, &job->h, out, n);
+      if (fwrite(out, sizeof *out, n, stdout) != n) return -1;
+      k-= n;
+   }
+   if (job->name) {
+      if (alphabet) if (putchar(' ') == EOF) return -1;
+      if (fputs(job->name, stdout) < 0) return -1;
+      if (!alphabet) if (putchar('\0') == EOF) return -1;
+   }
+   if (alphabet) if (putchar('\n') == EOF) return -1;
+   /* Count the output line as a single write. */
+   stats_write(
+      digest_chars + (job->name ? strlen(job->name) + 1 : 0)
+      + (alphabet ? (tree ? sizeof TREE_LABEL - 1 : 0) + 1 : 0), 0
+   );
+   return 0;
+}
+
+/* Compare the digest of the finished <job> with the one expected by the
+ * manifest and write the result to standard output. Returns 0 on success
+ * (whether the digests match or not), -1 on a write error and 1 if out of
+ * memory. */
+static int check_job(struct job *job) {
+   char const *result= "OK";
+   if (job->error) {
+      (void)fputs(job->error, stderr);
+      if (job->error_arg) {
+         (void)fputs(" \"", stderr);
+         (void)fputs(job->error_arg, stderr);
+         (void)fputs("\"!", stderr);
+      }
+      (void)fputc('\n', stderr);
+      result= "FAILED open or read"; ++unreadable;
+   } else if (!job->cached) {
+      unsigned char out[DIGEST_CHUNK];
+      struct encoder enc;
+      char const *expected= job->digest + (tree ? sizeof TREE_LABEL - 1 : 0);
+      size_t left= strlen(expected);
+      encode_init(&enc);
+      while (left) {
+         size_t n= left < DIM(out) ? left : DIM(out);
+         encode(&enc, &job->h, out, n);
+         if (memcmp(out, expected, n)) {
+            result= "FAILED"; ++mismatched;
+            break;
+         }
+         expected+= n; left-= n;
+      }
+   }
+   if (cache_fname && job->statted && !job->error && !strcmp(result, "OK")) {
+      struct cache_entry e;
+      cache_key(&e, &job->st);
+      if (cache_add(&new_cache, &e, job->digest)) return 1;
+   }
+   if (
+      fputs(job->name, stdout) < 0 || fputs(": ", stdout) < 0
+      || fputs(result, stdout) < 0 || putchar('\n') == EOF
+   ) {
+      return -1;
+   }
+   stats_write(strlen(job->name) + 2 + strlen(result) + 1, 0);
+   return 0;
+}
+
+/* Take jobs from <pool> and run them with <iobuf> until it is closed. */
+static void *worker(void *iobuf) {
+   for (;;) {
+      struct job *job;
+      (void)pthread_mutex_lock(&pool.lock);
+      while (pool.taken == pool.queued && !pool.closed) {
+         (void)pthread_cond_wait(&pool.work, &pool.lock);
+      }
+      if (pool.taken == pool.queued) {
+         (void)pthread_mutex_unlock(&pool.lock);
+         return 0;
+      }
+      job= &pool.slot[pool.taken++ % pool.slots];
+      (void)pthread_mutex_unlock(&pool.lock);
+      if (!job->cached) hash_job(job, iobuf, 0);
+      (void)pthread_mutex_lock(&pool.lock);
+      job->done= 1;
+      (void)pthread_cond_signal(&pool.done);
+      (void)pthread_mutex_unlock(&pool.lock);
+   }
 }
 
 int main(int argc, char **argv) {
    char const *error= 0;
+   char const *pathname= 0;
    int a= 0;
-   unsigned long digest_chars= 0;
-   char const *alphabet= b32custom_alphabet;
-   unsigned alphabet_bitmask= (int)DIM(b32custom_alphabet) - 1, alphabet_bits;
-   ARCFOUR_VARDEFS(static);
+   unsigned threads= 1;
+   pthread_t *workers= 0;
+   static unsigned char iobuf[IOBUF_OCTETS];
+   stats_init("treyfer-hash");
    {
       int optpos= 0;
       unsigned long digest_bits= 256;
@@ -177,7 +827,23 @@ int main(int argc, char **argv) {
                alphabet_bitmask= (unsigned)DIM(hex_alphabet) - 1;
                break;
             case 'r': alphabet= 0; alphabet_bitmask= (1 << 8) - 1; break;
-            case 'b': case 'B': case 'c':
+            case 't': treyfer= 1; break;
+            case 'T': tree= 1; break;
+            case 'f': list_delim= '\n'; break;
+            case 'C': case 'K':
+               if (
+                  !(
+                     pathname= getopt_simplest_mand_arg(
+                        &a, &optpos, argc, argv
+                     )
+                  )
+               ) {
+                  getopt_simplest_perror_missing_arg(opt); goto leave;
+               }
+               *(opt == 'C' ? &manifest_fname : &cache_fname)= pathname;
+               break;
+            case '0': list_delim= '\0'; break;
+            case 'b': case 'B': case 'c': case 'j':
                {
                   union {
                      char const *str;
@@ -188,6 +854,16 @@ int main(int argc, char **argv) {
                   ))) {
                      getopt_simplest_perror_missing_arg(opt); goto leave;
                   }
+                  if (opt == 'j') {
+                     if (
+                        (optarg.val= atol(optarg.str)) < 1
+                        || optarg.val > THREADS_MAX
+                     ) {
+                        error= "Invalid number of threads!"; goto fail;
+                     }
+                     threads= (unsigned)optarg.val;
+                     break;
+                  }
                   if ((optarg.val= atol(optarg.str)) < 1) {
                      bad_digest_size:
                      error= "Invalid digest size requested!"; goto fail;
@@ -206,6 +882,19 @@ int main(int argc, char **argv) {
                      }
                }
                break;
+            case 'S': case 'R':
+               if (
+                  !(
+                     pathname= getopt_simplest_mand_arg(
+                        &a, &optpos, argc, argv
+                     )
+                  )
+               ) {
+                  getopt_simplest_perror_missing_arg(opt); goto leave;
+               }
+               *(opt == 'S' ? &save_fname : &resume_fname)= pathname;
+               break;
+            case 'v': stats_enable(); break;
             case 'h': (void)fputs(help, stderr); /* Fall through. */
             case 'V': error= version_info; goto fail;
             default: getopt_simplest_perror_opt(opt); goto leave;
@@ -221,80 +910,144 @@ int main(int argc, char **argv) {
       if (digest_bits) {
          digest_chars= (digest_bits + alphabet_bits - 1) / alphabet_bits;
       }
-   }
-   for (;;) {
-      if (a < argc) {
-         if (!freopen(argv[a], "rb", stdin)) {
+      args= argv + a; args_left= argc - a;
+      list_fh= stdin;
+      if (manifest_fname) {
+         if (list_delim != EOF) {
+            error= "-C cannot be combined with -f or -0!"; goto fail;
+         }
+         if (!alphabet) {
+            error= "-C cannot be combined with -r!"; goto fail;
+         }
+         if (!(list_fh= fopen(pathname= manifest_fname, "r"))) {
             (void)fputs("Could not open", stderr);
-            add_arg:
-            (void)fputs(" \"", stderr);
-            (void)fputs(argv[a], stderr);
-            error= "\"!"; goto fail;
+            goto add_arg;
          }
+         list_delim= '\n';
+      } else if (cache_fname) {
+         error= "-K requires -C!"; goto fail;
       }
-      /* Hash current standard input */
-      ARCFOUR_STEP_1_KEY;
-      ARCFOUR_STEP_2;
-      /* Process input as an (overly long) key to set. */
-      {
-         int c;
-         while ((c= getchar()) != EOF) {
-            assert(c >= 0); assert(c < SBOX_SIZE);
-            ARCFOUR_STEP_4_KEY((unsigned)c);
-            ARCFOUR_STEP_5_DROP;
-            ARCFOUR_STEP_7_KEY;
+      if (list_delim != EOF) {
+         if (args_left) {
+            error= "File arguments cannot be combined with -f, -0 or -C!";
+            goto fail;
          }
+      } else if (!args_left) {
+         /* Only the leaves of standard input can be hashed in parallel. */
+         hash_stdin= 1; if (!tree) threads= 1;
+      }
+      if (
+         (save_fname || resume_fname) && (args_left > 1 || list_delim != EOF)
+      ) {
+         error= "-S and -R require a single input!"; goto fail;
       }
-      if (ferror(stdin)) {
-         if (a < argc) {
-            (void)fputs("Error reading", stderr);
+      if ((save_fname || resume_fname) && (treyfer || tree)) {
+         error= "-S and -R cannot be combined with -t or -T!"; goto fail;
+      }
+   }
+   if (cache_fname) {
+      switch (cache_load()) {
+         case 0: break;
+         case 1: goto nomem;
+         default:
+            (void)fputs("Could not read cache file", stderr);
+            pathname= cache_fname;
             goto add_arg;
-         }
-         error= "Read error!"; goto fail;
       }
-      assert(feof(stdin));
-      /* Finish key setup. */
-      ARCFOUR_STEP_2;
-      /* Drop the initial pseudorandom output. */
-      {
-         unsigned k;
-         for (k= DROP_N; k--; ) {
-            ARCFOUR_STEP_3_PRNG; ARCFOUR_STEP_4_PRNG; ARCFOUR_STEP_5_DROP;
+   }
+   if (threads > 1) {
+      unsigned char *iobufs;
+      unsigned i;
+      pool.slots= JOBS_PER_THREAD * threads;
+      if (
+         !(pool.slot= malloc(pool.slots * sizeof *pool.slot))
+         || !(workers= malloc(threads * sizeof *workers))
+         || !(iobufs= malloc((size_t)threads * IOBUF_OCTETS))
+      ) {
+         nomem: error= "Out of memory!"; goto fail;
+      }
+      for (i= 0; i < threads; ++i) {
+         if (
+            pthread_create(
+               &workers[i], 0, worker, iobufs + (size_t)i * IOBUF_OCTETS
+            )
+         ) {
+            error= "Could not create worker thread!"; goto fail;
          }
       }
-      /* Produce the message digest. */
-      {
-         unsigned long k;
-         unsigned buf, bufbits= 0;
-         #ifndef NDEBUG
-            buf= 0;
-         #endif
-         for (k= digest_chars; k--; ) {
-            if (bufbits < alphabet_bits) {
-               /* Append the bits of another ARCFOUR output octet to <buf>. */
-               ARCFOUR_STEP_3_PRNG; ARCFOUR_STEP_4_PRNG; ARCFOUR_STEP_5_PRNG;
-               buf= buf << 8 | ARCFOUR_STEP_6_PRNG();
-               bufbits+= 8;
-            }
-            assert(bufbits >= alphabet_bits);
-            {
-               unsigned c= buf >> bufbits - alphabet_bits & alphabet_bitmask;
-               if (alphabet) c= (unsigned)alphabet[c];
-               bufbits-= alphabet_bits;
-               if (putchar((int)c) != (int)c) goto wrerr;
+   }
+   for (;;) {
+      struct job *job;
+      static struct job single;
+      if (threads == 1 || tree) {
+         switch (next_job(job= &single)) {
+            case 0: goto all_written;
+            case -1: goto rderr;
+         }
+         if (!job->cached) hash_job(job, iobuf, 1);
+      } else {
+         /* Queue further jobs as long as there are free slots. */
+         while (!pool.closed && pool.queued - pool.written < pool.slots) {
+            switch (next_job(&pool.slot[pool.queued % pool.slots])) {
+               case 1: queue_job(); continue;
+               case -1: goto rderr;
             }
+            close_pool();
          }
-         if (a < argc) {
-            if (alphabet) if (putchar(' ') == EOF) goto wrerr;
-            if (fputs(argv[a], stdout) < 0) goto wrerr;
-            if (!alphabet) if (putchar('\0') == EOF) goto wrerr;
+         if (pool.written == pool.queued) goto all_written;
+         /* Wait for the oldest job, so that the output is in order. */
+         stats_phase("absorb");
+         job= oldest_job();
+      }
+      stats_reads(job->reads, job->bytes_in);
+      if (manifest_fname) {
+         stats_phase("verify");
+         switch (check_job(job)) {
+            case 0: break;
+            case 1: goto nomem;
+            default: goto wrerr;
          }
-         if (alphabet) if (putchar('\n') == EOF) goto wrerr;
+      } else {
+         if (job->error) {
+            if (!(pathname= job->error_arg)) {
+               error= job->error; goto fail;
+            }
+            (void)fputs(job->error, stderr);
+            goto add_arg;
+         }
+         /* Produce the message digest. */
+         stats_phase("digest");
+         if (put_digest(job)) goto wrerr;
       }
-      if (!(++a < argc)) break;
+      free(job->alloc);
+   }
+   all_written:
+   if (threads > 1) {
+      unsigned i;
+      close_pool();
+      for (i= 0; i < threads; ++i) (void)pthread_join(workers[i], 0);
+   }
+   if (cache_fname && cache_save()) {
+      (void)fputs("Could not write cache file", stderr);
+      pathname= cache_fname;
+      goto add_arg;
+   }
+   if (mismatched || unreadable || bad_lines) {
+      if (fflush(0)) goto wrerr;
+      (void)fprintf(
+         stderr
+         , "%lu mismatched, %lu unreadable, %lu improperly formatted lines.\n"
+         , mismatched, unreadable, bad_lines
+      );
+      error= "Verification failed!"; goto fail;
    }
    if (fflush(0)) {
-      wrerr: error= "Write error!";
+      wrerr: error= "Write error!"; goto fail;
+      rderr: error= "Read error!"; goto fail;
+      add_arg:
+      (void)fputs(" \"", stderr);
+      (void)fputs(pathname, stderr);
+      error= "\"!";
       fail:
       (void)fputs(error, stderr);
       (void)fputc('\n', stderr);
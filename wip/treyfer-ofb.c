@@ -1,5 +1,5 @@
-#define VERSTR_1 "Version 2020.355"
-#define VERSTR_2 "Copyright (c) 2020 Guenther Brunthaler."
+#define VERSTR_1 "Version 2026.290"
+#define VERSTR_2 "Copyright (c) 2020-2026 Guenther Brunthaler."
 
 static char help[]= { /* Formatted as 66 output columns. */
    "treyfer-ofb - stream cipher encryption/decryption\n"
@@ -82,6 +82,11 @@ static char help[]= { /* Formatted as 66 output columns. */
    "* After the loop finishes, the S-box has been constructed and will\n"
    "then be used as-is.\n"
    "\n"
+   "If the environment variable SIMPENC_STATS is set to anything but\n"
+   "an empty string or \"0\", statistics about the duration of the\n"
+   "phases of the program and about its I/O are written to standard\n"
+   "error when it exits.\n"
+   "\n"
    VERSTR_1 "\n"
    "\n"
    VERSTR_2 " All rights reserved.\n"
@@ -90,90 +95,66 @@ static char help[]= { /* Formatted as 66 output columns. */
    "Distribution is permitted under the terms of the GPLv3."
 };
 
+#define _POSIX_C_SOURCE 200112L
 #include <dim_sdbrke8ae851uitgzm4nv3ea2.h>
+#include <simpenc_12xa3exh75vq0l98qouxald4m.h>
 #include <limits.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
+#include "stats_common.h"
 
-#define IS_POWER_OF_2(n) (~((n) - 1) % (n) == 0)
+/* Read the label <c> followed by <n> octets into <dst>. Returns 0 if the
+ * input does not match. */
+static int read_param(int c, unsigned char *dst, unsigned n) {
+   if (getchar() != c) return 0;
+   while (n--) {
+      if ((c= getchar()) == EOF) return 0;
+      assert(c >= 0); assert(c <= UCHAR_MAX);
+      *dst++= (unsigned char)c;
+   }
+   return 1;
+}
 
 int main(int argc, char **argv) {
    char const *error= 0;
-   static unsigned char sbox[1 << CHAR_BIT];
-   unsigned char key[8], block[8];
+   static struct simpenc_treyfer_ofb ofb;
+   static unsigned char buf[BUFSIZ];
+   unsigned char key[SIMPENC_TREYFER_OFB_KEY_OCTETS];
+   unsigned char sbc[SIMPENC_TREYFER_OFB_SBC_OCTETS];
+   unsigned char iv[SIMPENC_TREYFER_OFB_IV_OCTETS];
+   stats_init("treyfer-ofb");
    if (argc > 1) { usage: error= help; goto fail; }
    (void)argv;
-   if (getchar() != 'K') goto usage;
-   /* Read key. No special key setup is required by the algorithm. */
-   {
-      unsigned n;
-      for (n= 0; n < (unsigned)DIM(key); ++n) {
-         int c;
-         if ((c= getchar()) == EOF) goto usage;
-         assert(c >= 0); assert(c <= UCHAR_MAX);
-         key[n]= (unsigned char)c;
-      }
+   /* No special key setup is required by the algorithm. The IV is the
+    * initial block contents for OFB mode. */
+   if (
+      !read_param('K', key, (unsigned)DIM(key))
+      || !read_param('S', sbc, (unsigned)DIM(sbc))
+      || !read_param('I', iv, (unsigned)DIM(iv))
+      || getchar() != 'T'
+   ) {
+      goto usage;
    }
-   if (getchar() != 'S') goto usage;
-   /* Read S-box configuration data and construct S-box from it. */
+   simpenc_treyfer_ofb_init(&ofb, key, sbc, iv);
    {
       unsigned n;
-      /* Preset identity substitution. */
-      for (n= (unsigned)DIM(sbox); n--; ) sbox[n]= (unsigned char)n;
-      for (n= 0; n < (unsigned)DIM(sbox); ++n) {
-         int c;
-         if ((c= getchar()) == EOF) goto usage;
-         assert(c >= 0); assert(c <= (int)DIM(sbox));
-         {
-            unsigned char t;
-            t= sbox[c]; sbox[c]= sbox[n]; sbox[n]= t;
-         }
-      }
-      for (n= 0; n < (unsigned)DIM(sbox); ++n) {
-         fprintf(stderr, ", 0x%02x", sbox[n]);
+      for (n= 0; n < (unsigned)DIM(ofb.sbox); ++n) {
+         fprintf(stderr, ", 0x%02x", ofb.sbox[n]);
       }
    }
-   if (getchar() != 'I') goto usage;
-   /* Read IV. Use as the initial block contents for OFB mode. */
-   {
-      unsigned n;
-      for (n= 0; n < (unsigned)DIM(block); ++n) {
-         int c;
-         if ((c= getchar()) == EOF) goto usage;
-         assert(c >= 0); assert(c <= UCHAR_MAX);
-         block[n]= (unsigned char)c;
-      }
-   }
-   if (getchar() != 'T') goto usage;
    /* Encrypt or decrypt standard input to standard output. */
-   {
-      int c;
-      unsigned o= 0;
-      assert(IS_POWER_OF_2(DIM(key)));
-      assert(IS_POWER_OF_2(DIM(block)));
-      assert(IS_POWER_OF_2(CHAR_BIT));
-      while ((c= getchar()) != EOF) {
-         #define MOD(x, m) ((unsigned char)(x) & (unsigned char)((m) - 1))
-         #define MOD_A(x, array) MOD(x, DIM(array))
-         if (o == 0) {
-            #define NUMROUNDS 32
-            unsigned i;
-            unsigned char t= block[0];
-            for (i= 0; i < CHAR_BIT * NUMROUNDS; ++i) {
-               t+= key[MOD_A(i, key)];
-               t= MOD_A(sbox[t] + block[MOD_A(i + 1, block)], sbox);
-               /* ROT-L by 1 bit. */
-               block[MOD_A(i + 1, block)]= t= t << 1 | t >> CHAR_BIT - 1;
-            }
-         }
-         assert(c >= 0); assert(c <= UCHAR_MAX);
-         c^= block[o];
-         o= MOD_A(o + 1, block);
-         if (putchar(c) != c) goto wrerr;
-         #undef MOD_A
-         #undef MOD
-      }
+   stats_phase("bulk");
+   for (;;) {
+      size_t got;
+      uint64_t t0= stats_io_begin();
+      got= fread(buf, sizeof *buf, DIM(buf), stdin);
+      stats_read(got, t0);
+      if (!got) break;
+      simpenc_treyfer_ofb_crypt(&ofb, buf, buf, got);
+      t0= stats_io_begin();
+      if (fwrite(buf, sizeof *buf, got, stdout) != got) goto wrerr;
+      stats_write(got, t0);
    }
    if (ferror(stdin)) { error= "Read error!"; goto fail; }
    assert(feof(stdin));
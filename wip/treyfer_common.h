@@ -0,0 +1,176 @@
+/*
+ * Treyfer block encryption kernels for shared use in different
+ * applications.
+ *
+ * All kernels take the S-box as an argument, so that applications with a
+ * configurable S-box can use them as well. Pass the array from
+ * "treyfer_sbox.h" for the "nothing up my sleeve" S-box.
+ *
+ * Version 2026.290
+ *
+ * Copyright (c) 2020-2026 Guenther Brunthaler. All rights reserved.
+ *
+ * This source file is free software.
+ * Distribution is permitted under the terms of the GPLv3.
+ */
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TREYFER_MOD(x, m) ((unsigned char)(x) & (unsigned char)((m) - 1))
+
+/* Octets of a block and of a key for treyfer_encrypt_64(). */
+#define TREYFER_64_OCTETS 8
+
+/* Octets of a block and of a key for treyfer_encrypt_512(), and of a digest
+ * and of a message block for treyfer_compress(). */
+#define TREYFER_512_OCTETS 64
+
+/* Original Treyfer: Encrypt the 64-bit <block> in place with the 64-bit
+ * <key>, using 32 rounds. */
+static inline void treyfer_encrypt_64(
+   unsigned char *block, unsigned char const *key, unsigned char const *sbox
+) {
+   #define NUMROUNDS 32
+   unsigned i;
+   unsigned char t= block[0];
+   for (i= 0; i < CHAR_BIT * NUMROUNDS; ++i) {
+      t+= key[TREYFER_MOD(i, TREYFER_64_OCTETS)];
+      t= TREYFER_MOD(
+         sbox[t] + block[TREYFER_MOD(i + 1, TREYFER_64_OCTETS)], 1 << 8
+      );
+      /* ROT-L by 1 bit. */
+      block[TREYFER_MOD(i + 1, TREYFER_64_OCTETS)]= t=
+         (unsigned char)(t << 1 | t >> CHAR_BIT - 1)
+      ;
+   }
+   #undef NUMROUNDS
+}
+
+/* Treyfer with its block and key size bumped to 512 bit and the number of
+ * rounds scaled by the same factor. Encrypts <block> in place. */
+static inline void treyfer_encrypt_512(
+   unsigned char *block, unsigned char const *key, unsigned char const *sbox
+) {
+   #define ORIGINAL_BLOCK_BITS 64
+   #define ORIGINAL_ROUNDS 32
+   #define FACTOR_BIGGER 8
+   #define NUMROUNDS (ORIGINAL_ROUNDS * FACTOR_BIGGER)
+   unsigned i;
+   unsigned char t= block[0];
+   for (i= 0; i < ORIGINAL_BLOCK_BITS / 8 * NUMROUNDS; ) {
+      /* This is the core of the Treyfer algorithm. */
+      t= t + key[TREYFER_MOD(i, TREYFER_512_OCTETS)] & 0xff;
+      ++i;
+      t= TREYFER_MOD(
+         sbox[t] + block[TREYFER_MOD(i, TREYFER_512_OCTETS)], 1 << 8
+      );
+      /* ROT-L by 1 bit. */
+      block[TREYFER_MOD(i, TREYFER_512_OCTETS)]= t= (unsigned char)(
+         t + t & 0xff | t >> CHAR_BIT - 1
+      );
+   }
+   #undef NUMROUNDS
+   #undef FACTOR_BIGGER
+   #undef ORIGINAL_ROUNDS
+   #undef ORIGINAL_BLOCK_BITS
+}
+
+/* Compress the 64-octet message <block> into the 64-octet <digest>. This is
+ * the Treyfer MAC with an all-zero key: Encrypt the digest like
+ * treyfer_encrypt_512() does, then XOR the block into it. */
+static inline void treyfer_compress(
+   unsigned char *digest, unsigned char const *block,
+   unsigned char const *sbox
+) {
+   #define NUMROUNDS (32 * 8)
+   unsigned r, i;
+   unsigned char t= *digest;
+   for (r= 0; r < CHAR_BIT * NUMROUNDS; ++r) {
+      i= TREYFER_MOD(r + 1, TREYFER_512_OCTETS);
+      t= TREYFER_MOD(sbox[t] + digest[i], 1 << 8);
+      /* ROT-L by 1 bit. */
+      digest[i]= t= (unsigned char)(t << 1 | t >> CHAR_BIT - 1);
+   }
+   #undef NUMROUNDS
+   for (i= TREYFER_512_OCTETS; i--; ) digest[i]^= block[i];
+}
+
+/* Hash built on treyfer_compress(). The message is padded like SHA-256
+ * does with its 64-octet blocks: An octet 0x80, then zero octets up to 8
+ * octets before the end of a block, then the message length in bits as a
+ * 64-bit big-endian number. The blocks are compressed into an initially
+ * all-zero digest. Any number of output octets can then be squeezed out;
+ * every 64 of them are the digest after compressing another all-zero
+ * block into it.
+ *
+ * Call treyfer_hash_init(), treyfer_hash_update() for the message, then
+ * treyfer_hash_final() and treyfer_hash_squeeze() as often as required. */
+struct treyfer_hash {
+   unsigned char digest[TREYFER_512_OCTETS], block[TREYFER_512_OCTETS];
+   unsigned used; /* Octets in <block>, or of <digest> already squeezed. */
+   uint64_t octets; /* Message length. */
+};
+
+static inline void treyfer_hash_init(struct treyfer_hash *ctx) {
+   unsigned i;
+   for (i= TREYFER_512_OCTETS; i--; ) ctx->digest[i]= 0;
+   ctx->used= 0; ctx->octets= 0;
+}
+
+static inline void treyfer_hash_update(
+   struct treyfer_hash *ctx, void const *data, size_t n
+   , unsigned char const *sbox
+) {
+   unsigned char const *p= data;
+   unsigned used= ctx->used;
+   ctx->octets+= n;
+   if (used) {
+      while (n && used < TREYFER_512_OCTETS) { ctx->block[used++]= *p++; --n; }
+      if (used < TREYFER_512_OCTETS) { ctx->used= used; return; }
+      treyfer_compress(ctx->digest, ctx->block, sbox);
+   }
+   /* Compress whole blocks directly from <data>. */
+   for (; n >= TREYFER_512_OCTETS; n-= TREYFER_512_OCTETS) {
+      treyfer_compress(ctx->digest, p, sbox);
+      p+= TREYFER_512_OCTETS;
+   }
+   for (used= 0; n--; ) ctx->block[used++]= *p++;
+   ctx->used= used;
+}
+
+static inline void treyfer_hash_final(
+   struct treyfer_hash *ctx, unsigned char const *sbox
+) {
+   uint64_t bits= ctx->octets << 3;
+   unsigned used= ctx->used, i;
+   ctx->block[used++]= 0x80;
+   if (used > TREYFER_512_OCTETS - 8) {
+      while (used < TREYFER_512_OCTETS) ctx->block[used++]= 0;
+      treyfer_compress(ctx->digest, ctx->block, sbox);
+      used= 0;
+   }
+   while (used < TREYFER_512_OCTETS - 8) ctx->block[used++]= 0;
+   for (i= TREYFER_512_OCTETS; i-- > used; bits>>= 8) {
+      ctx->block[i]= (unsigned char)(bits & 0xff);
+   }
+   treyfer_compress(ctx->digest, ctx->block, sbox);
+   /* Nothing of the digest has been squeezed out yet. */
+   ctx->used= TREYFER_512_OCTETS;
+   for (i= TREYFER_512_OCTETS; i--; ) ctx->block[i]= 0;
+}
+
+/* Write the next <n> octets of the digest to <out>. */
+static inline void treyfer_hash_squeeze(
+   struct treyfer_hash *ctx, unsigned char *out, size_t n
+   , unsigned char const *sbox
+) {
+   while (n--) {
+      if (ctx->used == TREYFER_512_OCTETS) {
+         treyfer_compress(ctx->digest, ctx->block, sbox);
+         ctx->used= 0;
+      }
+      *out++= ctx->digest[ctx->used++];
+   }
+}